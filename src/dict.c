@@ -1,9 +1,76 @@
+#define _POSIX_C_SOURCE 200809L
 #include "dict.h"
+#include <sched.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <io.h>
+    #define dict_fsync( fp )    _commit( _fileno( fp ) )
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define dict_fsync( fp )    fsync( fileno( fp ) )
+#endif  // _WIN32
 
 #define DEFAULT_MOD     8
 #define DEFAULT_STEP    2
+#define DEFAULT_LOAD    1
+#define DEFAULT_FILL    0.25
+#define SMALL_MAX       8
+#define DENSE_MIN_SPAN  64
 #define HASH_BASE       256LLU
 #define HASH_MOD        1000000007LLU
+#define SIGN_BIT        ( 1LLU << 63 )
+#define FILTER_BITS     10
+#define FILTER_MIN      64
+#define FILTER_LINE     64
+#define BIN_MIN         8
+#define BIN_DROP        6
+#define BUILD_PARTS     4
+#define SET_BATCH       16
+#define SWMR_BATCH      64
+#define PAR_CHUNKS      16
+#define PAR_DESTROY     0
+#define PAR_FOREACH     1
+#define PAR_REDUCE      2
+#define AGG_HOT         64
+#define TTL_BITS        6
+#define TTL_SLOTS       ( 1 << TTL_BITS )
+#define TTL_LEVELS      6
+#define TTL_DUE         ( TTL_LEVELS * TTL_SLOTS )
+#define TTL_FAR         ( TTL_DUE + 1 )
+#define TTL_SPAN        ( TTL_BITS * TTL_LEVELS )
+#define TTL_BUDGET      4
+#define ARENA_MIN       64
+#define ARENA_MAX       4096
+#define SERIAL_SPLIT    ( 1U << 31 )
+#define PROF_SUBS       8
+#define POOL_MOD        64
+#define SNAPSHOT_BATCH  64
+#define SNAPSHOT_FLUSH  ( 1 << 16 )
+#define ORDER_PENDING   ( SIZE_MAX ^ ( SIZE_MAX >> 1 ) )
+#define ORDER_OF(T,a,b) ( ( *(const T*) (a) > *(const T*) (b) ) - ( *(const T*) (a) < *(const T*) (b) ) )
+#define LOG_BATCH       ( 1 << 16 )
+#define LOG_PUT         1
+#define LOG_DEL         2
+#define SHM_MAGIC       0x6d6873746369644cLLU
+#define SHM_ALIGN       16
+#define SHM_SMALL       512
+#define SHM_CLASSES     96
+#if defined( __GNUC__ ) || defined( __clang__ )
+    #define dict_prefetch( ptr )    __builtin_prefetch( ptr )
+    #define dict_load( ptr )        __atomic_load_n( ptr, __ATOMIC_ACQUIRE )
+    #define dict_store( ptr, val )  __atomic_store_n( ptr, val, __ATOMIC_RELEASE )
+#else
+    #define dict_prefetch( ptr )    ( (void) ( ptr ) )
+    #define dict_load( ptr )        ( *(ptr) )
+    #define dict_store( ptr, val )  ( *(ptr) = (val) )
+#endif  // __GNUC__
 #define ASSERT_MEM(x)   if(x==NULL){fprintf(stderr,"[ERRO]: out of memory.\n");exit(1);}
 
 typedef struct dict_elem dict_elem_t;
@@ -20,877 +87,6006 @@ typedef struct dict_list
     size_t          size;
     dict_elem_t*    head;
     dict_elem_t*    tail;
+    dict_elem_t**   bin;        // nodes sorted by code then key, only kept for chains of at least BIN_MIN nodes
+    size_t          cap;        // capacity of `bin`
 } dict_list_t;
 
+typedef struct dict_dense
+{
+    bool            enable;     // integer key type and dense mode requested
+    bool            on;         // keys are currently stored in `data` instead of `list`
+    double          fill;
+    uint64_t        base;       // position of the first slot
+    size_t          span;       // amount of slots
+    char*           data;       // slots of key followed by val
+    uint64_t*       bits;       // presence bitmap of the slots
+    uint64_t        lo;         // smallest position inserted while hashed
+    uint64_t        hi;         // largest position inserted while hashed
+} dict_dense_t;
+
+typedef struct dict_filter
+{
+    bool            enable;
+    uint32_t        bits;       // bits per key
+    size_t          blocks;     // amount of cache line sized blocks
+    size_t          capacity;   // amount of keys the filter was sized for
+    size_t          removed;    // keys removed since the last rebuild, their bits are still set
+    void*           raw;        // allocation backing `data`
+    uint64_t*       data;       // blocks aligned to cache line
+    uint64_t        queries;
+    uint64_t        negatives;
+    uint64_t        false_positives;
+} dict_filter_t;
+
+typedef struct dict_clock
+{
+    dict_elem_t*    prev;
+    dict_elem_t*    next;
+    bool            ref;        // used since the hand last passed
+} dict_clock_t;
+
+typedef struct dict_cache
+{
+    bool            enable;
+    size_t          offset;     // offset of `dict_clock_t` from the key of a node
+    size_t          max_len;
+    size_t          max_bytes;
+    size_t          bytes;
+    dict_evict      evict;
+    void*           ctx;
+    dict_elem_t*    hand;
+} dict_cache_t;
+
+typedef struct dict_expiry
+{
+    uint64_t        deadline;   // time the pair expires at, 0 if it never does
+    dict_elem_t*    prev;
+    dict_elem_t*    next;
+    uint32_t        where;      // list of the wheel holding the node
+} dict_expiry_t;
+
+// hierarchical timing wheel. A node sits at the highest level where its deadline and `tick` differ, in the slot of that digit of the deadline,
+// so every slot of a level lies ahead of `tick` and is moved down a level once `tick` reaches it
+typedef struct dict_ttl
+{
+    bool            enable;
+    size_t          offset;     // offset of `dict_expiry_t` from the key of a node
+    dict_now        now;
+    void*           ctx;
+    size_t          budget;
+    size_t          count;      // nodes with a deadline
+    uint64_t        tick;       // time the wheel has been advanced to
+    uint64_t        bits[ TTL_LEVELS ];     // non-empty slots of every level
+    dict_elem_t**   slots;      // every level, then the expired nodes, then the ones too far ahead for the wheel
+} dict_ttl_t;
+
+// fixed size val slots for split storage, blocks never move so vals keep their address
+typedef struct dict_arena
+{
+    bool            enable;
+    size_t          slot;       // bytes of a slot, the key of the owning node followed by the val
+    size_t          count;      // slots of the next block
+    char*           blocks;     // every block, chained through their first bytes
+    char*           top;        // next slot never handed out
+    char*           end;
+    char*           free;       // released slots, chained through their first bytes
+} dict_arena_t;
+
+#ifdef DICT_PROFILE
+// sampled latencies of a dict
+typedef struct dict_prof
+{
+    dict_profile_t      data;
+    uint32_t            left;       // operations until the next sample
+} dict_prof_t;
+#endif  // DICT_PROFILE
+
+typedef struct dict_buffer
+{
+    char*           data;
+    size_t          size;
+    size_t          cap;
+} dict_buffer_t;
+
+typedef struct dict_order
+{
+    bool            enable;
+    dict_cmpr       cmpr;
+    size_t          offset;     // offset of the position of a node in `items` or `pending` from its key
+    dict_elem_t**   items;      // nodes sorted by key as of the last refresh, removed ones are NULL
+    size_t          len;
+    dict_buffer_t   pending;    // nodes inserted since the last refresh, removed ones are NULL
+    size_t          removed;    // NULL entries in `items` and `pending`
+    void*           bound;      // lower bound of a range, while the upper one is in `key_temp`
+} dict_order_t;
+
+struct dict_snapshot
+{
+    dict_t*             dict;
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    atomic_uchar*       done;       // buckets already copied into the snapshot
+    size_t              mod;        // amount of buckets when the snapshot began, resizing waits until it ends
+    dict_writer         write;
+    void*               ctx;
+    uint32_t            header[3];
+    dict_buffer_t       items;      // records not handed to `write` yet
+    dict_buffer_t       strs;       // DICT_STR keys, placed after all the records
+    bool                failed;
+};
+
+typedef struct dict_log
+{
+    FILE*           fp;
+    char*           path;
+    size_t          batch;      // bytes of records written and synced together
+    dict_buffer_t   records;    // records not written yet
+    char*           item;       // key of the val handed out by the last call, logged once the next call comes in
+    void*           before;     // content of that val when it was handed out
+    bool            inserted;
+    bool            failed;
+} dict_log_t;
+
+typedef struct dict_retired
+{
+    uint64_t        epoch;      // epoch when it left the dict
+    void*           ptr;
+    size_t          size;       // size of a block, 0 for a node
+    bool            val;        // the val of a node is freed too
+} dict_retired_t;
+
+typedef struct dict_swmr
+{
+    bool                    enable;
+    size_t                  batch;      // retired entries reclaimed together
+    atomic_uint_fast64_t    epoch;      // advanced by every reclamation
+    atomic_uint_fast64_t    seq;        // odd while the buckets are being reshaped
+    pthread_mutex_t         lock;       // guards `readers`, lookups never take it
+    dict_reader_t*          readers;
+    dict_buffer_t           retired;    // nodes and bucket arrays readers may still be walking
+} dict_swmr_t;
+
+struct dict_reader
+{
+    alignas( FILTER_LINE ) atomic_uint_fast64_t epoch;  // epoch seen when the read section began, 0 outside of one
+    dict_t*         dict;
+    void*           key_temp;
+    dict_reader_t*  prev;
+    dict_reader_t*  next;
+};
+
+typedef struct dict_agg
+{
+    bool                enable;
+    dict_agg_op_t       op;
+    dict_type_t         type;
+    dict_combine        combine;
+    void*               ctx;
+    pthread_mutex_t     lock;       // guards `pending`, only taken to hand a table over or to collect them
+    dict_buffer_t       pending;    // local tables handed over and not merged yet
+} dict_agg_t;
+
+struct dict_local
+{
+    dict_t*         dict;
+    dict_t*         table;              // pairs folded since the last flush, NULL until the first one
+    dict_elem_t*    hot[ AGG_HOT ];     // node of the last key seen for every few bits of the hash code
+};
+
+typedef struct dict_build
+{
+    dict_t*             dict;
+    const char*         keys;
+    const char*         vals;
+    size_t              n;
+    size_t              val_data;   // size of a val in `vals`
+    size_t              nthreads;
+    size_t              parts;      // partitions, each one a contiguous range of buckets
+    size_t              width;      // buckets per partition
+    int                 phase;
+    uint64_t*           codes;      // hash code of every key
+    size_t*             count;      // entries per thread and partition, turned into offsets into `order`
+    size_t*             bounds;     // first entry of every partition in `order`
+    size_t*             order;      // input indices grouped by partition, in input order within each one
+    dict_conflict_t     policy;
+    dict_combine        combine;
+    void*               ctx;
+} dict_build_t;
+
+typedef struct dict_build_task
+{
+    dict_build_t*       build;
+    size_t              id;
+    pthread_t           thread;
+    bool                spawned;
+    void*               key;        // padded copy of a DICT_STRUCT key
+    void*               val;        // padded copy of a val
+    size_t              len;        // pairs inserted
+    uint64_t            lo;         // smallest position inserted, for dense mode
+    uint64_t            hi;         // largest position inserted, for dense mode
+} dict_build_task_t;
+
+// range of chunks [lo, hi) owned by a worker, packed so the owner and the thieves agree through one compare and swap
+typedef struct dict_par_range
+{
+    alignas( FILTER_LINE ) atomic_uint_fast64_t range;
+} dict_par_range_t;
+
+typedef struct dict_par
+{
+    dict_t*             dict;
+    int                 op;
+    size_t              nthreads;
+    size_t              slots;      // buckets, or slots while direct-indexed
+    size_t              width;      // slots per chunk
+    dict_par_range_t*   ranges;     // one per worker
+    dict_each           each;
+    dict_reduce         reduce;
+    void*               ctx;
+} dict_par_t;
+
+typedef struct dict_par_task
+{
+    dict_par_t*         par;
+    size_t              id;
+    pthread_t           thread;
+    bool                spawned;
+    void*               acc;        // partial result of a reduction
+} dict_par_task_t;
+
+// rows of the columns written by one thread, starting at `row` with the pairs of the buckets in `[from, to)`
+typedef struct dict_export_task
+{
+    const dict_t*   dict;
+    size_t          from;
+    size_t          to;
+    size_t          row;
+    size_t          rows;       // rows that fit into the columns
+    char*           keys;
+    size_t          key_stride;
+    char*           vals;
+    size_t          val_stride;
+    pthread_t       thread;
+    bool            spawned;
+} dict_export_task_t;
+
+// a string of a pool, handed out as the address of `str`
+typedef struct dict_intern dict_intern_t;
+struct dict_intern
+{
+    dict_intern_t*  next;
+    uint64_t        code;       // the one dicts without `key.hash` give the string
+    size_t          length;
+    size_t          refs;
+    char            str[];
+};
+
+struct dict_pool
+{
+    dict_alloc_t        alloc;
+    pthread_mutex_t     lock;
+    size_t              len;
+    size_t              mod;
+    dict_intern_t**     slots;
+};
+
+typedef struct dict_cursor
+{
+    size_t          index;
+    dict_elem_t*    elem;
+} dict_cursor_t;
+
+// keys of one dict looked up together in another one
+typedef struct dict_set_batch
+{
+    size_t          len;
+    char*           items[ SET_BATCH ];     // key followed by val
+    dict_elem_t*    elems[ SET_BATCH ];     // node of each item, NULL while direct-indexed
+    uint64_t        codes[ SET_BATCH ];
+    dict_elem_t*    hits[ SET_BATCH ];      // node of the same key in the other dict, NULL if missing or direct-indexed
+    bool            found[ SET_BATCH ];
+} dict_set_batch_t;
+
 struct dict
 {
     dict_key_attr_t     key;
     dict_val_attr_t     val;
     dict_alloc_t        alloc;
     size_t              mod;
+    size_t              len;
     dict_list_t*        list;
-    void*               key_temp;
+    dict_list_t         small;      // the only bucket while the dict holds up to SMALL_MAX pairs, the bucket array is allocated once it outgrows it
+    void*               key_temp;   // placed right after the dict
+    size_t              key_data;   // size of the key passed in by the user for DICT_STRUCT
+    size_t              node_size;  // size of a node including the data placed after the val
+    dict_dense_t        dense;
+    dict_filter_t       filter;
+    dict_cache_t        cache;
+    dict_order_t        order;
+    dict_snapshot_t*    snap;       // running background snapshot
+    dict_log_t*         log;        // mutation log
+    dict_swmr_t         swmr;       // lock free readers
+    size_t              val_data;   // size of the val passed in by the user
+    dict_agg_t          agg;        // per-thread local tables
+    dict_ttl_t          ttl;        // expiry of the pairs
+    dict_arena_t        arena;      // vals kept apart from the nodes
+#ifdef DICT_PROFILE
+    dict_prof_t*        prof;       // NULL unless profiling
+#endif  // DICT_PROFILE
 };
 
-
-static inline bool dict_reshape( dict_t* restrict dict, size_t step )
+// start of a shared region, every link inside the region is an offset from its start, 0 for none
+typedef struct dict_shm_head
 {
-    size_t old_size = dict->mod;
-    size_t new_size = old_size * step * DEFAULT_STEP;
-
-    dict_list_t* old_list = dict->list;
-    dict_list_t* new_list = dict->alloc.malloc( sizeof (dict_list_t) * new_size );
+    _Atomic uint64_t    magic;      // set by the creator once the rest is ready
+    uint32_t            key_type;
+    uint32_t            key_data;   // size of the key passed in by the user for DICT_STRUCT
+    uint64_t            val_data;   // size of the val passed in by the user
+    uint64_t            bytes;      // size of the region
+    pthread_rwlock_t    lock;       // process shared
+    uint64_t            len;
+    uint64_t            mod;
+    uint64_t            buckets;    // first node of every chain
+    uint64_t            top;        // start of the space never handed out
+    uint64_t            free[SHM_CLASSES];  // released blocks of every size class
+} dict_shm_head_t;
 
-    if ( new_list == NULL ) return false;
+typedef struct dict_shm_elem
+{
+    uint64_t            code;
+    uint64_t            next;
+    char                key[];      // DICT_STR keys hold the offset of the string
+} dict_shm_elem_t;
 
-    dict->mod   = new_size;
-    dict->list  = new_list;
+struct dict_shm
+{
+    dict_t              proto;      // key attribute and `key_temp` of the process, only used to read keys, hash and compare them
+    dict_shm_head_t*    head;
+    char*               base;       // where the region is mapped in this process
+    size_t              node_size;
+};
 
-    memset( dict->list, 0, sizeof (dict_list_t) * new_size );
 
-    dict_elem_t* curr;
-    dict_elem_t* next;
-    uint64_t index;
-    for ( size_t i = 0; i < old_size; i++ )
+// every allocation goes through the context aware interface, `malloc` and `free` are wrapped into it
+static void* dict_std_alloc( void* ctx, size_t size, size_t align )
+{
+    (void) ctx;
+#ifndef _WIN32
+    // `aligned_alloc` wants a multiple of the alignment
+    if ( align > alignof (max_align_t) )
     {
-        curr = old_list[i].head;
-        while ( curr != NULL )
-        {
-            next    = curr->next;
-            index   = curr->code % new_size;
-            
-            if ( new_list[ index ].head == NULL )
-            {
-                new_list[ index ].head = new_list[ index ].tail = curr;
-                curr->prev = NULL;
-            }
-            else
-            {
-                new_list[ index ].tail->next = curr;
-                new_list[ index ].tail = curr;
-                curr->prev = new_list[ index ].tail;
-            }
-            new_list[ index ].size++;
-            curr = next;
-        }
+        return aligned_alloc( align, ( size + align - 1 ) & ~( align - 1 ) );
     }
+#else
+    (void) align;
+#endif  // _WIN32
+    return malloc( size );
+}
 
-    for ( size_t i = 0; i < new_size; i++ )
-    {
-        new_list[i].tail->next = NULL;
-    }
 
-    if ( dict->alloc.free != NULL )
+static void dict_std_dealloc( void* ctx, void* ptr, size_t size )
+{
+    (void) ctx;
+    (void) size;
+    free( ptr );
+}
+
+
+static void* dict_std_realloc( void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align )
+{
+    // `realloc` only keeps the alignment of `malloc`
+    if ( align > alignof (max_align_t) )
     {
-        dict->alloc.free( old_list );
+        void* data = dict_std_alloc( ctx, new_size, align );
+        if ( data == NULL ) return NULL;
+        memcpy( data, ptr, old_size < new_size ? old_size : new_size );
+        free( ptr );
+        return data;
     }
+    (void) ctx;
+    return realloc( ptr, new_size );
+}
 
-    return true;
+
+// `ctx` is the `dict_alloc_t` holding `malloc` and `free`, larger alignments than `malloc` gives are handled by `dict_alloc_aligned`
+static void* dict_v1_alloc( void* ctx, size_t size, size_t align )
+{
+    (void) align;
+    return ( (dict_alloc_t*) ctx )->malloc( size );
 }
 
 
-static inline void* dict_get_key( const dict_t* restrict dict, va_list ap )
+static void dict_v1_dealloc( void* ctx, void* ptr, size_t size )
 {
-    void* key = dict->key_temp;
-    if ( dict->key.copy != NULL )
+    (void) size;
+    dict_free free = ( (dict_alloc_t*) ctx )->free;
+    if ( free != NULL )
     {
-        void* data = va_arg( ap, void* );
-        dict->key.copy( key, data );
-    }
-    else
-    {
-        switch ( dict->key.type )
-        {
-            case DICT_CHAR:         *(char*)        key = va_arg( ap, int );            break;
-            case DICT_WCHAR:        *(wchar_t*)     key = va_arg( ap, int );            break;
-            case DICT_I32:          *(int32_t*)     key = va_arg( ap, int32_t );        break;
-            case DICT_U32:          *(uint32_t*)    key = va_arg( ap, uint32_t );       break;
-            case DICT_F32:          *(float*)       key = va_arg( ap, double );         break;
-            case DICT_I64:          *(int64_t*)     key = va_arg( ap, int64_t );        break;
-            case DICT_U64:          *(uint64_t*)    key = va_arg( ap, uint64_t );       break;
-            case DICT_F64:          *(double*)      key = va_arg( ap, double );         break;
-            case DICT_PTR:          *(void**)       key = va_arg( ap, void* );          break;
-            case DICT_STR:
-            {
-                char* str = va_arg( ap, char* );
-                *(char**) key = dict->alloc.malloc( strlen(str) + 1 );
-                ASSERT_MEM( *(char**) key );
-                strcpy( *(char**) key, str );
-                break;
-            }
-            case DICT_STRUCT:
-            {
-                void* data = va_arg( ap, void* );
-                memcpy( key, data, dict->key.size );
-                break;
-            }
-            default:                fprintf( stderr, "[ERRO]: illegal type.\n" );       exit(1);
-        }
+        free( ptr );
     }
-    return key;
 }
 
 
-static inline uint64_t dict_get_hash( const dict_t* restrict dict, void* restrict key )
+// for an arena without `dealloc`
+static void dict_no_dealloc( void* ctx, void* ptr, size_t size )
 {
-    uint64_t code = 0;
-    if ( dict->key.hash != NULL )
+    (void) ctx;
+    (void) ptr;
+    (void) size;
+}
+
+
+// fill in the context aware interface, `self` is where the result will be stored
+static inline dict_alloc_t dict_alloc_init( dict_alloc_t alloc, dict_alloc_t* self )
+{
+    if ( alloc.alloc != NULL )
     {
-        code = dict->key.hash( key );
+        if ( alloc.dealloc == NULL ) alloc.dealloc = dict_no_dealloc;
+    }
+    else if ( alloc.malloc != NULL )
+    {
+        alloc.ctx     = self;
+        alloc.alloc   = dict_v1_alloc;
+        alloc.dealloc = dict_v1_dealloc;
+        alloc.realloc = NULL;
     }
     else
     {
-        size_t length;
-        switch ( dict->key.type )
+        alloc = (dict_alloc_t)
         {
-            case DICT_CHAR:         code = *(char*)     key;    break;
-            case DICT_WCHAR:        code = *(wchar_t*)  key;    break;
-            case DICT_I32:          code = *(int32_t*)  key;    break;
-            case DICT_U32:          code = *(uint32_t*) key;    break;
-            case DICT_F32:          code = *(float*)    key;    break;
-            case DICT_I64:          code = *(int64_t*)  key;    break;
-            case DICT_U64:          code = *(uint64_t*) key;    break;
-            case DICT_F64:          code = *(double*)   key;    break;
-            case DICT_PTR:
-            {
-                code = *(uintptr_t*) key;
-                break;
-            }
-            case DICT_STR:          
-                length = strlen( *(char**) key );
-                for ( size_t i = 0; i < length; i++ )
-                {
-                    code = ( code * HASH_BASE + ( *(char**) key )[i] ) % HASH_MOD;
-                }
-                break;
-            case DICT_STRUCT:
-                length = dict->key.size;
-                for ( size_t i = 0; i < length; i++ )
-                {
-                    code = ( code * HASH_BASE + ( (char*) key )[i] ) % HASH_MOD;
-                }
-                break;
-            default:
-            {
-                fprintf( stderr, "[ERRO]: illegal type.\n" );
-                exit(1);
-            }
-        }
+            .malloc  = malloc,
+            .free    = free,
+            .alloc   = dict_std_alloc,
+            .dealloc = dict_std_dealloc,
+            .realloc = dict_std_realloc,
+        };
     }
-    return code;
+    return alloc;
 }
 
 
-static inline void dict_free_key( const dict_t* restrict dict, void* restrict key )
+// true if a block allocated by one can be released by the other
+static inline bool dict_alloc_same( const dict_alloc_t* restrict a, const dict_alloc_t* restrict b )
 {
-    if ( dict->key.copy != NULL && dict->key.free != NULL )
-    {
-        dict->key.free( key );
-    }
-    else if ( dict->key.type == DICT_STR )
-    {
-        dict->alloc.free( *(char**) key );
-    }
+    if ( a->alloc != b->alloc || a->dealloc != b->dealloc ) return false;
+    if ( a->alloc == dict_v1_alloc ) return a->malloc == b->malloc && a->free == b->free;
+    return a->ctx == b->ctx;
 }
 
 
-static inline void dict_free_val( const dict_t* restrict dict, void* restrict val )
+static inline void* dict_alloc_mem( const dict_t* restrict dict, size_t size )
 {
-    if ( dict->val.free != NULL )
+    return dict->alloc.alloc( dict->alloc.ctx, size, alignof (max_align_t) );
+}
+
+
+static inline void dict_free_mem( const dict_t* dict, void* ptr, size_t size )
+{
+    dict->alloc.dealloc( dict->alloc.ctx, ptr, size );
+}
+
+
+// the wrapped `malloc` can not align past `max_align_t`, neither can libc on Windows, so the block is aligned by hand as the filter does
+static inline bool dict_align_by_hand( const dict_alloc_t* restrict alloc, size_t align )
+{
+#ifdef _WIN32
+    return align > alignof (max_align_t) && ( alloc->alloc == dict_v1_alloc || alloc->alloc == dict_std_alloc );
+#else
+    return align > alignof (max_align_t) && alloc->alloc == dict_v1_alloc;
+#endif  // _WIN32
+}
+
+
+// for types declared with a larger alignment, released by `dict_free_aligned` with the same `size` and `align`
+static inline void* dict_alloc_aligned( const dict_t* restrict dict, size_t size, size_t align )
+{
+    if ( dict_align_by_hand( &dict->alloc, align ) == false )
     {
-        dict->val.free( val );
+        return dict->alloc.alloc( dict->alloc.ctx, size, align );
     }
+
+    // the address of the whole block is kept right before the aligned one
+    char* raw = dict_alloc_mem( dict, size + align - 1 + sizeof (void*) );
+    if ( raw == NULL ) return NULL;
+    char* ptr = (char*) ( ( (uintptr_t) raw + sizeof (void*) + align - 1 ) & ~(uintptr_t) ( align - 1 ) );
+    memcpy( ptr - sizeof (void*), &raw, sizeof (void*) );
+    return ptr;
 }
 
 
-static inline void dict_free_node( const dict_t* restrict dict, dict_elem_t* restrict node )
+static inline void dict_free_aligned( const dict_t* restrict dict, void* restrict ptr, size_t size, size_t align )
 {
-    if ( dict->alloc.free != NULL )
+    if ( dict_align_by_hand( &dict->alloc, align ) == false )
     {
-        dict->alloc.free( node );
+        dict_free_mem( dict, ptr, size );
+        return;
     }
+
+    void* raw;
+    memcpy( &raw, (char*) ptr - sizeof (void*), sizeof (void*) );
+    dict_free_mem( dict, raw, size + align - 1 + sizeof (void*) );
 }
 
 
-static inline void dict_delete_node( dict_list_t* restrict list, dict_elem_t* restrict curr )
+static inline void* dict_realloc_mem( const dict_t* restrict dict, void* restrict ptr, size_t old_size, size_t new_size )
 {
-    if ( curr == list->head )
+    if ( dict->alloc.realloc != NULL && ptr != NULL )
     {
-        list->head = curr->next;
+        return dict->alloc.realloc( dict->alloc.ctx, ptr, old_size, new_size, alignof (max_align_t) );
     }
-    if ( curr == list->tail )
+
+    void* grow = dict_alloc_mem( dict, new_size );
+    if ( grow != NULL && ptr != NULL )
     {
-        list->tail = curr->prev;
+        memcpy( grow, ptr, old_size < new_size ? old_size : new_size );
+        dict_free_mem( dict, ptr, old_size );
     }
-    if ( curr->prev != NULL )
+    return grow;
+}
+
+
+// address of the val of a pair, `item` being the key of a node or of a slot. Split storage keeps a pointer to the val instead
+static inline char* dict_item_val( const dict_t* restrict dict, const char* restrict item )
+{
+    return dict->arena.enable ? *(char* const*) ( item + dict->key.size ) : (char*) item + dict->key.size;
+}
+
+
+// key of the pair holding the val at `val`
+static inline char* dict_val_item( const dict_t* restrict dict, const char* restrict val )
+{
+    return dict->arena.enable ? *(char* const*) ( val - sizeof (char*) ) : (char*) val - dict->key.size;
+}
+
+
+// take a slot for the val of the node with key `item`, blocks grow up to ARENA_MAX slots
+static inline char* dict_arena_alloc( dict_t* restrict dict, char* restrict item )
+{
+    dict_arena_t* arena = &dict->arena;
+    char*         slot  = arena->free;
+    if ( slot != NULL )
     {
-        curr->prev->next = curr->next;
+        arena->free = *(char**) slot;
     }
-    if ( curr->next != NULL )
+    else
     {
-        curr->next->prev = curr->prev;
+        if ( arena->top == arena->end )
+        {
+            size_t bytes = alignof (max_align_t) + arena->slot * arena->count;
+            char*  block = dict_alloc_mem( dict, bytes );
+            ASSERT_MEM( block );
+            ( (char**) block )[0] = arena->blocks;
+            ( (size_t*) block )[1] = bytes;
+            arena->blocks = block;
+            arena->top    = block + alignof (max_align_t);
+            arena->end    = block + bytes;
+            arena->count  = arena->count < ARENA_MAX ? arena->count * DEFAULT_STEP : ARENA_MAX;
+        }
+        slot = arena->top;
+        arena->top += arena->slot;
     }
-    list->size--;
+    *(char**) slot = item;
+    *(char**) ( item + dict->key.size ) = slot + sizeof (char*);
+    return slot + sizeof (char*);
 }
 
 
-dict_t* dict_create( dict_args_t args )
+static inline void dict_arena_free( dict_t* restrict dict, char* restrict val )
 {
-    size_t key_size;
-    switch ( args.key.type )
-    {
-        case DICT_CHAR:    key_size = sizeof ( char );                      break;
-        case DICT_WCHAR:   key_size = sizeof ( wchar_t );                   break;
-        case DICT_I32:     key_size = sizeof ( int32_t );                   break;
-        case DICT_U32:     key_size = sizeof ( uint32_t );                  break;
-        case DICT_F32:     key_size = sizeof ( float );                     break;
-        case DICT_I64:     key_size = sizeof ( int64_t );                   break;
-        case DICT_U64:     key_size = sizeof ( uint64_t );                  break;
-        case DICT_F64:     key_size = sizeof ( double );                    break;
-        case DICT_PTR:     key_size = sizeof ( void* );                     break;
-        case DICT_STR:     key_size = sizeof ( char* );                     break;
-        case DICT_STRUCT:  
-        {
-            key_size = ( args.key.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
-            break;
-        }
-        default:           fprintf( stderr, "[ERRO]: illegal type.\n" );    exit(1);
+    char* slot = val - sizeof (char*);
+    *(char**) slot = dict->arena.free;
+    dict->arena.free = slot;
+}
+
+
+static inline void dict_arena_release( dict_t* restrict dict )
+{
+    while ( dict->arena.blocks != NULL )
+    {
+        char* block = dict->arena.blocks;
+        dict->arena.blocks = ( (char**) block )[0];
+        dict_free_mem( dict, block, ( (size_t*) block )[1] );
     }
+}
 
-    size_t val_size = ( args.val.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
 
-    dict_t* dict = NULL;
-    if ( args.alloc.malloc != NULL )
+static inline void dict_list_append( dict_list_t* restrict list, dict_elem_t* restrict elem )
+{
+    // the node is complete before readers can reach it
+    elem->prev = list->tail;
+    dict_store( &elem->next, NULL );
+    if ( list->head == NULL )
     {
-        dict = args.alloc.malloc( sizeof (dict_t) );
-        ASSERT_MEM( dict );
-        dict->alloc = args.alloc;
+        dict_store( &list->head, elem );
     }
     else
     {
-        dict = malloc( sizeof (dict_t) );
-        ASSERT_MEM( dict );
-        dict->alloc = (dict_alloc_t)
-        {
-            .malloc = malloc,
-            .free   = free,
-        };
+        dict_store( &list->tail->next, elem );
     }
+    list->tail = elem;
+    list->size++;
+}
 
-    dict->key = args.key;
-    dict->key.size = key_size;
-
-    dict->val = args.val;
-    dict->val.size = val_size;
 
-    dict->key_temp = dict->alloc.malloc( dict->key.size );
-    ASSERT_MEM( dict->key_temp );
+static inline bool dict_filter_rebuild( dict_t* restrict dict );
+static inline void dict_bin_build( const dict_t* restrict dict, dict_list_t* restrict list );
+static inline void dict_bin_free( const dict_t* restrict dict, dict_list_t* restrict list );
+static inline void dict_swmr_retire( dict_t* restrict dict, void* ptr, size_t size, bool val );
 
-    dict->mod   = DEFAULT_MOD;
-    dict->list  = dict->alloc.malloc( sizeof (dict_list_t) * dict->mod );
-    ASSERT_MEM( dict->list );
-    memset( dict->list, 0, sizeof (dict_list_t) * dict->mod );
 
-    return dict;
+#ifdef DICT_PROFILE
+static inline uint64_t dict_prof_clock( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
 }
 
 
-dict_t* dict_new( dict_type_t key_type, size_t key_size, size_t val_size )
+// the first PROF_SUBS buckets hold one value each, then every power of two is split into PROF_SUBS buckets
+static inline size_t dict_prof_bucket( uint64_t nanos )
 {
-    return dict_create( (dict_args_t)
+    if ( nanos < PROF_SUBS ) return nanos;
+    size_t shift = 0;
+    while ( ( nanos >> shift ) >= 2 * PROF_SUBS )
     {
-        .key = (dict_key_attr_t)
-        {
-            .type = key_type,
-            .size = key_size,
-        },
-        .val = (dict_val_attr_t)
-        {
-            .size = val_size,
-        },
-        .alloc = (dict_alloc_t) { 0 },
-    });
+        shift++;
+    }
+    return ( shift + 1 ) * PROF_SUBS + ( nanos >> shift ) - PROF_SUBS;
 }
 
 
-void dict_destroy( dict_t* restrict dict )
+static inline void dict_prof_record( dict_prof_hist_t* restrict hist, uint64_t nanos )
 {
-    for ( size_t i = 0; i < dict->mod; i++ )
-    {
-        dict_elem_t* curr = dict->list[i].head;
-        dict_elem_t* next;
-        while ( curr != NULL )
-        {
-            next = curr->next;
-            
-            dict_free_key( dict, curr->key );
-            if ( dict->val.size != 0 )
-            {
-                dict_free_val( dict, curr->key + dict->key.size );
-            }
-            dict_free_node( dict, curr );
+    hist->count++;
+    hist->total += nanos;
+    hist->max    = nanos > hist->max ? nanos : hist->max;
+    hist->buckets[ dict_prof_bucket( nanos ) ]++;
+}
 
-            curr = next;
-        }
-    }
 
-    if ( dict->alloc.free != NULL )
-    {
-        dict->alloc.free( dict->key_temp );
-        dict->alloc.free( dict->list );
-        dict->alloc.free( dict );
-        dict = NULL;
-    }
+// return the start time if this operation is sampled, 0 otherwise
+static inline uint64_t dict_prof_begin( const dict_t* restrict dict )
+{
+    dict_prof_t* prof = dict->prof;
+    if ( prof == NULL || --prof->left != 0 ) return 0;
+    prof->left = prof->data.sample;
+    return dict_prof_clock();
 }
 
 
-void* dict_get( dict_t* restrict dict, ... )
+static inline void dict_prof_end( const dict_t* restrict dict, dict_prof_op_t op, uint64_t start )
 {
-    va_list ap;
-    va_start( ap, dict );
+    dict_prof_record( &dict->prof->data.ops[ op ], dict_prof_clock() - start );
+}
 
-    // get the key
-    void* key = dict_get_key( dict, ap );
+    #define PROF_BEGIN( dict )      uint64_t prof_start = dict_prof_begin( dict )
+    #define PROF_END( dict, op )    if ( prof_start != 0 ) dict_prof_end( dict, op, prof_start )
+#else
+    #define PROF_BEGIN( dict )
+    #define PROF_END( dict, op )
+#endif  // DICT_PROFILE
 
-    va_end(ap);
 
-    // get hash code
-    uint64_t code = dict_get_hash( dict, key );
+// move every node into `new_size` buckets, 1 for the inline bucket of a small dict
+static inline bool dict_rehash( dict_t* restrict dict, size_t new_size )
+{
+    size_t old_size = dict->mod;
+
+    dict_list_t* old_list = dict->list;
+    dict_list_t* new_list = new_size == 1 ? &dict->small : dict_alloc_mem( dict, sizeof (dict_list_t) * new_size );
+
+    if ( new_list == NULL ) return false;
+
+    memset( new_list, 0, sizeof (dict_list_t) * new_size );
 
-    // get into the linked list
-    size_t index = code % dict->mod;
-    for ( dict_elem_t* curr = dict->list[ index ].head; curr != NULL; curr = curr->next )
+    // readers that see the new `mod` see the new `list` as well, and retry the lookups that overlapped with the moves. Buckets of such a dict are never shrunk
+    if ( dict->swmr.enable )
     {
-        if ( curr->code != code ) continue;
-        if ( dict->key.cmpr != NULL )
+        atomic_store_explicit( &dict->swmr.seq, atomic_load_explicit( &dict->swmr.seq, memory_order_relaxed ) + 1, memory_order_relaxed );
+        atomic_thread_fence( memory_order_release );
+    }
+    dict_store( &dict->list, new_list );
+    dict_store( &dict->mod, new_size );
+
+    dict_elem_t* curr;
+    dict_elem_t* next;
+    for ( size_t i = 0; i < old_size; i++ )
+    {
+        curr = old_list[i].head;
+        while ( curr != NULL )
         {
-            if ( dict->key.cmpr( curr->key, key ) == 0 )
-            {
-                dict_free_key( dict, key );
-                return curr->key + dict->key.size;
-            }
+            next = curr->next;
+            dict_list_append( &new_list[ curr->code & ( new_size - 1 ) ], curr );
+            curr = next;
         }
-        else
+        dict_bin_free( dict, &old_list[i] );
+    }
+
+    // the inline bucket of a small dict stays where it is, it is cleared once used again
+    if ( dict->swmr.enable )
+    {
+        atomic_store_explicit( &dict->swmr.seq, atomic_load_explicit( &dict->swmr.seq, memory_order_relaxed ) + 1, memory_order_release );
+        if ( old_list != &dict->small )
         {
-            switch ( dict->key.type )
-            {
-                case DICT_CHAR:
-                case DICT_WCHAR:
-                case DICT_I32:
-                case DICT_U32:
-                case DICT_F32:
-                case DICT_I64:
-                case DICT_U64:
-                case DICT_F64:
-                case DICT_PTR:
-                case DICT_STRUCT:
-                {
-                    if ( memcmp( curr->key, key, dict->key.size ) == 0 )
-                    {
-                        dict_free_key( dict, key );
-                        return curr->key + dict->key.size;
-                    }
-                    break;
-                }
-                case DICT_STR:
-                {
-                    if ( strcmp( *(char**) curr->key, *(char**) key ) == 0 )
-                    {
-                        dict_free_key( dict, key );
-                        return curr->key + dict->key.size;
-                    }
-                    break;
-                }
-                default:
-                {
-                    fprintf( stderr, "[ERRO]: illegal type.\n" );
-                    exit(1);
-                }
-            }
+            dict_swmr_retire( dict, old_list, sizeof (dict_list_t) * old_size, false );
+        }
+    }
+    else if ( old_list != &dict->small )
+    {
+        dict_free_mem( dict, old_list, sizeof (dict_list_t) * old_size );
+    }
+
+    // chains still long after spreading keep a sorted index
+    for ( size_t i = 0; new_size > 1 && i < new_size; i++ )
+    {
+        if ( new_list[i].size >= BIN_MIN )
+        {
+            dict_bin_build( dict, &new_list[i] );
         }
     }
 
-    // doesn't already appear in the list
-    dict_elem_t* elem = dict->alloc.malloc( sizeof (dict_elem_t) + dict->key.size + dict->val.size );
-    ASSERT_MEM( elem );
-    *elem = (dict_elem_t)
+    // the filter is resized together with the buckets, which also clears the bits of removed keys
+    if ( dict->filter.enable )
     {
-        .code   = code,
-        .prev   = dict->list[ index ].tail,
-    };
-    memcpy( elem->key, key, dict->key.size );
-    memset( elem->key + dict->key.size, 0, dict->val.size );
-    if ( dict->list[ index ].size == 0 )
+        return dict_filter_rebuild( dict );
+    }
+
+    return true;
+}
+
+
+static inline bool dict_resize( dict_t* restrict dict, size_t new_size )
+{
+#ifdef DICT_PROFILE
+    // every resize is timed, they are rare and each one is a latency spike of its own
+    if ( dict->prof != NULL )
     {
-        dict->list[ index ].head = dict->list[ index ].tail = elem;
+        size_t   from  = dict->mod;
+        uint64_t start = dict_prof_clock();
+        bool     done  = dict_rehash( dict, new_size );
+        uint64_t nanos = dict_prof_clock() - start;
+
+        dict_profile_t* data = &dict->prof->data;
+        dict_prof_record( &data->ops[ DICT_PROF_RESHAPE ], nanos );
+        data->resize[ data->resizes++ % DICT_PROF_RESIZES ] = (dict_prof_resize_t) { .nanos = nanos, .from = from, .to = dict->mod, .len = dict->len };
+        return done;
     }
-    else
+#endif  // DICT_PROFILE
+    return dict_rehash( dict, new_size );
+}
+
+
+// grow the buckets `step * DEFAULT_STEP` times, a small dict moves straight to SMALL_MAX * DEFAULT_STEP buckets at least
+static inline bool dict_reshape( dict_t* restrict dict, size_t step )
+{
+    size_t new_size = dict->mod * step * DEFAULT_STEP;
+    if ( dict->list == &dict->small && new_size < SMALL_MAX * DEFAULT_STEP )
     {
-        dict->list[ index ].tail->next = elem;
-        dict->list[ index ].tail = elem;
+        new_size = SMALL_MAX * DEFAULT_STEP;
     }
-    if ( dict->list[ index ].size++ > dict->mod )
+    return dict_resize( dict, new_size );
+}
+
+
+// give memory back after a lot of removals, the buckets are halved until at most half of them would be used, or go back to the inline bucket
+static inline void dict_shrink( dict_t* restrict dict )
+{
+    // readers pair `mod` with `list` assuming the buckets only grow
+    if ( dict->dense.on || dict->snap != NULL || dict->swmr.enable || dict->list == &dict->small ) return;
+
+    size_t new_size = 1;
+    if ( dict->len > SMALL_MAX )
     {
-        if ( dict_reshape( dict, 1 ) == false )
+        new_size = SMALL_MAX * DEFAULT_STEP;
+        while ( dict->len * DEFAULT_STEP > new_size * DEFAULT_LOAD )
         {
-            return NULL;
+            new_size *= DEFAULT_STEP;
         }
     }
-    return elem->key + dict->key.size;
+    // the buckets are left as they are if out of memory
+    if ( new_size < dict->mod )
+    {
+        dict_resize( dict, new_size );
+    }
 }
 
 
-bool dict_remove( dict_t* restrict dict, ... )
+// more than `count` pairs do not fit within the load factor, or into the inline bucket of a small dict
+static inline bool dict_overloaded( const dict_t* restrict dict, size_t count )
 {
-    va_list ap;
-    va_start( ap, dict );
+    return count > ( dict->list == &dict->small ? SMALL_MAX : dict->mod * DEFAULT_LOAD );
+}
 
-    // get the key
-    void* key = dict_get_key( dict, ap );
 
-    va_end(ap);
+// grow the buckets once so that `count` pairs fit within the load factor
+static inline bool dict_presize( dict_t* restrict dict, size_t count )
+{
+    if ( dict_overloaded( dict, count ) == false ) return true;
+
+    size_t mod = dict->mod;
+    while ( count > mod * DEFAULT_LOAD )
+    {
+        mod *= DEFAULT_STEP;
+    }
+    if ( mod == dict->mod || dict->dense.on || dict->snap != NULL ) return true;
+    return dict_reshape( dict, mod / dict->mod / DEFAULT_STEP );
+}
 
-    // get hash code
-    uint64_t code = dict_get_hash( dict, key );
 
-    // get into the linked list
-    size_t index = code % dict->mod;
-    for ( dict_elem_t* curr = dict->list[ index ].head; curr != NULL; curr = curr->next )
+// borrow the key passed in, the key is only copied once it gets inserted. `key` receives the key, or the address of it for DICT_STR
+static inline void* dict_read_key( const dict_t* restrict dict, void* restrict key, va_list ap )
+{
+    if ( dict->key.copy != NULL )
     {
-        if ( curr->code != code ) continue;
-        if ( dict->key.cmpr != NULL )
+        void* data = va_arg( ap, void* );
+        memcpy( key, data, dict->key_data );
+    }
+    else
+    {
+        switch ( dict->key.type )
         {
-            if ( dict->key.cmpr( curr->key, key ) == 0 )
+            case DICT_CHAR:         *(char*)        key = va_arg( ap, int );            break;
+            case DICT_WCHAR:        *(wchar_t*)     key = va_arg( ap, int );            break;
+            case DICT_I32:          *(int32_t*)     key = va_arg( ap, int32_t );        break;
+            case DICT_U32:          *(uint32_t*)    key = va_arg( ap, uint32_t );       break;
+            case DICT_F32:          *(float*)       key = va_arg( ap, double );         break;
+            case DICT_I64:          *(int64_t*)     key = va_arg( ap, int64_t );        break;
+            case DICT_U64:          *(uint64_t*)    key = va_arg( ap, uint64_t );       break;
+            case DICT_F64:          *(double*)      key = va_arg( ap, double );         break;
+            case DICT_PTR:          *(void**)       key = va_arg( ap, void* );          break;
+            case DICT_STR:          *(char**)       key = va_arg( ap, char* );          break;
+            case DICT_STRUCT:
             {
-                // redirect node
-                dict_free_key( dict, key );
-                dict_delete_node( &dict->list[ index ], curr );
-                // delete key and val and node
-                dict_free_key( dict, curr->key );
-                dict_free_val( dict, curr->key + dict->key.size );
-                dict_free_node( dict, curr );
-                return true;
-            }
-        }
-        else
-        {
-            switch ( dict->key.type )
-            {
-                case DICT_CHAR:
-                case DICT_WCHAR:
-                case DICT_I32:
-                case DICT_U32:
-                case DICT_F32:
-                case DICT_I64:
-                case DICT_U64:
-                case DICT_F64:
-                case DICT_PTR:
-                case DICT_STRUCT:
-                {
-                    if ( memcmp( curr->key, key, dict->key.size ) == 0 )
-                    {
-                        // redirect node
-                        dict_free_key( dict, key );
-                        dict_delete_node( &dict->list[ index ], curr );
-                        // delete key and val and node
-                        dict_free_key( dict, curr->key );
-                        dict_free_val( dict, curr->key + dict->key.size );
-                        dict_free_node( dict, curr );
-                        return true;
-                    }
-                    break;
-                }
-                case DICT_STR:
-                {
-                    if ( strcmp( curr->key, key ) == 0 )
-                    {
-                        // redirect node
-                        dict_free_key( dict, key );
-                        dict_delete_node( &dict->list[ index ], curr );
-                        // delete key and val and node
-                        dict_free_key( dict, curr->key );
-                        dict_free_val( dict, curr->key + dict->key.size );
-                        dict_free_node( dict, curr );
-                        return true;
-                    }
-                    break;
-                }
-                default:
-                {
-                    fprintf( stderr, "[ERRO]: illegal type.\n" );
-                    exit(1);
-                }
+                void* data = va_arg( ap, void* );
+                memcpy( key, data, dict->key_data );
+                break;
             }
+            default:                fprintf( stderr, "[ERRO]: illegal type.\n" );       exit(1);
         }
     }
+    return key;
+}
 
-    // doesn't already appear in the list
-    dict_free_key( dict, key );
-    return false;
+
+static inline void* dict_get_key( const dict_t* restrict dict, va_list ap )
+{
+    return dict_read_key( dict, dict->key_temp, ap );
 }
 
 
-bool dict_has( const dict_t* restrict dict, ... )
+// murmur3 finalizer, spreads every input bit over the whole code
+static inline uint64_t dict_mix( uint64_t code )
 {
-    va_list ap;
-    va_start( ap, dict );
+    code ^= code >> 33;
+    code *= 0xff51afd7ed558ccdLLU;
+    code ^= code >> 33;
+    code *= 0xc4ceb9fe1a85ec53LLU;
+    code ^= code >> 33;
+    return code;
+}
 
-    void* key = dict_get_key( dict, ap );
 
-    va_end(ap);
+// bit pattern of a float key, with -0.0 folded into 0.0 and every NaN into a single one
+static inline uint64_t dict_float_bits( const dict_t* restrict dict, const void* restrict key )
+{
+    if ( dict->key.type == DICT_F32 )
+    {
+        float    f = *(const float*) key;
+        uint32_t bits;
+        if ( f == 0 ) f = 0;
+        memcpy( &bits, &f, sizeof bits );
+        return f != f ? 0x7fc00000LLU : bits;
+    }
+    double   d = *(const double*) key;
+    uint64_t bits;
+    if ( d == 0 ) d = 0;
+    memcpy( &bits, &d, sizeof bits );
+    return d != d ? 0x7ff8000000000000LLU : bits;
+}
 
-    uint64_t code = dict_get_hash( dict, key );
 
-    // get into the linked list
-    size_t index = code % dict->mod;
-    for ( dict_elem_t* curr = dict->list[ index ].head; curr != NULL; curr = curr->next )
+static inline uint64_t dict_hash_str( const char* restrict str )
+{
+    uint64_t code = 0;
+    for ( ; *str != '\0'; str++ )
     {
-        if ( curr->code != code ) continue;
-        if ( dict->key.cmpr != NULL )
+        code = ( code * HASH_BASE + *str ) % HASH_MOD;
+    }
+    return code;
+}
+
+
+static inline uint64_t dict_get_hash( const dict_t* restrict dict, const void* restrict key )
+{
+    uint64_t code = 0;
+    if ( dict->key.hash != NULL )
+    {
+        code = dict->key.hash( key );
+    }
+    else
+    {
+        size_t length;
+        switch ( dict->key.type )
         {
-            if ( dict->key.cmpr( curr->key, key ) == 0 )
+            case DICT_CHAR:         code = *(char*)     key;    break;
+            case DICT_WCHAR:        code = *(wchar_t*)  key;    break;
+            case DICT_I32:          code = *(int32_t*)  key;    break;
+            case DICT_U32:          code = *(uint32_t*) key;    break;
+            case DICT_F32:          code = dict_float_bits( dict, key );    break;
+            case DICT_I64:          code = *(int64_t*)  key;    break;
+            case DICT_U64:          code = *(uint64_t*) key;    break;
+            case DICT_F64:          code = dict_float_bits( dict, key );    break;
+            case DICT_PTR:
             {
-                return true;
+                code = *(uintptr_t*) key;
+                break;
             }
-        }
-        else
-        {
-            switch ( dict->key.type )
-            {
-                case DICT_CHAR:
-                case DICT_WCHAR:
-                case DICT_I32:
-                case DICT_U32:
-                case DICT_F32:
-                case DICT_I64:
-                case DICT_U64:
-                case DICT_F64:
-                case DICT_PTR:
-                case DICT_STRUCT:
-                {
-                    if ( memcmp( curr->key, key, dict->key.size ) == 0 )
-                    {
-                        dict_free_key( dict, key );
-                        return true;
-                    }
-                    break;
-                }
-                case DICT_STR:
-                {
-                    if ( strcmp( curr->key, key ) == 0 )
-                    {
-                        dict_free_key( dict, key );
-                        return true;
-                    }
-                    break;
-                }
-                default:
+            case DICT_STR:
+                code = dict_hash_str( *(char**) key );
+                break;
+            case DICT_STRUCT:
+                length = dict->key.size;
+                for ( size_t i = 0; i < length; i++ )
                 {
-                    fprintf( stderr, "[ERRO]: illegal type.\n" );
-                    exit(1);
+                    code = ( code * HASH_BASE + ( (char*) key )[i] ) % HASH_MOD;
                 }
+                break;
+            default:
+            {
+                fprintf( stderr, "[ERRO]: illegal type.\n" );
+                exit(1);
             }
         }
     }
 
-    // doesn't already appear in the list
-    dict_free_key( dict, key );
-    return false;
+    // buckets are picked by the low bits, so every code is mixed, the ones from `key.hash` included
+    return dict_mix( code );
 }
 
 
-size_t dict_len( const dict_t* restrict dict )
+static inline bool dict_key_equal( const dict_t* restrict dict, const void* key1, const void* key2 )
 {
-    size_t size = 0;
-    for ( size_t i = 0; i < dict->mod; i++ )
+    if ( dict->key.cmpr != NULL )
+    {
+        return dict->key.cmpr( key1, key2 ) == 0;
+    }
+    switch ( dict->key.type )
     {
-        size += dict->list[i].size;
+        case DICT_CHAR:
+        case DICT_WCHAR:
+        case DICT_I32:
+        case DICT_U32:
+        case DICT_I64:
+        case DICT_U64:
+        case DICT_PTR:
+        case DICT_STRUCT:
+        {
+            return memcmp( key1, key2, dict->key.size ) == 0;
+        }
+        case DICT_F32:
+        case DICT_F64:
+        {
+            return dict_float_bits( dict, key1 ) == dict_float_bits( dict, key2 );
+        }
+        case DICT_STR:
+        {
+            // keys of the same pool are equal only if they are the same string
+            return *(char**) key1 == *(char**) key2 || strcmp( *(char**) key1, *(char**) key2 ) == 0;
+        }
+        default:
+        {
+            fprintf( stderr, "[ERRO]: illegal type.\n" );
+            exit(1);
+        }
     }
-    return size;
 }
 
 
-const void* dict_key( const dict_t* restrict dict, size_t* restrict size )
+static inline dict_intern_t* dict_pool_entry( const char* restrict str )
 {
-    *size = dict_len( dict );
+    return (dict_intern_t*) ( str - offsetof( dict_intern_t, str ) );
+}
 
-    if ( *size == 0 )
+
+// take a reference to the string in the pool, adding it if it is not there yet
+static const char* dict_pool_acquire( dict_pool_t* restrict pool, const char* restrict str, uint64_t code )
+{
+    size_t length = strlen( str );
+    pthread_mutex_lock( &pool->lock );
+    for ( dict_intern_t* curr = pool->slots[ code & ( pool->mod - 1 ) ]; curr != NULL; curr = curr->next )
     {
-        return NULL;
+        if ( curr->code == code && curr->length == length && memcmp( curr->str, str, length ) == 0 )
+        {
+            curr->refs++;
+            pthread_mutex_unlock( &pool->lock );
+            return curr->str;
+        }
     }
 
-    char* arr = dict->alloc.malloc( dict->key.size * (*size) );
-
-    size_t index = 0;
-    for ( size_t i = 0; i < dict->mod; i++ )
+    // one string per slot on average, keep the old slots if out of memory
+    if ( pool->len >= pool->mod )
     {
-        for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
+        size_t          mod   = pool->mod * DEFAULT_STEP;
+        dict_intern_t** slots = pool->alloc.alloc( pool->alloc.ctx, sizeof (dict_intern_t*) * mod, alignof (dict_intern_t*) );
+        if ( slots != NULL )
         {
-            memcpy( arr + ( dict->key.size * index ), curr->key, dict->key.size );
-            if ( index++ == *size ) return arr;
+            memset( slots, 0, sizeof (dict_intern_t*) * mod );
+            for ( size_t i = 0; i < pool->mod; i++ )
+            {
+                dict_intern_t* next;
+                for ( dict_intern_t* curr = pool->slots[i]; curr != NULL; curr = next )
+                {
+                    next = curr->next;
+                    curr->next = slots[ curr->code & ( mod - 1 ) ];
+                    slots[ curr->code & ( mod - 1 ) ] = curr;
+                }
+            }
+            pool->alloc.dealloc( pool->alloc.ctx, pool->slots, sizeof (dict_intern_t*) * pool->mod );
+            pool->slots = slots;
+            pool->mod   = mod;
         }
     }
 
-    return arr;
+    dict_intern_t* intern = pool->alloc.alloc( pool->alloc.ctx, sizeof (dict_intern_t) + length + 1, alignof (dict_intern_t) );
+    if ( intern == NULL )
+    {
+        pthread_mutex_unlock( &pool->lock );
+        return NULL;
+    }
+    intern->code   = code;
+    intern->length = length;
+    intern->refs   = 1;
+    memcpy( intern->str, str, length + 1 );
+    intern->next   = pool->slots[ code & ( pool->mod - 1 ) ];
+    pool->slots[ code & ( pool->mod - 1 ) ] = intern;
+    pool->len++;
+    pthread_mutex_unlock( &pool->lock );
+    return intern->str;
 }
 
 
-void* dict_serialize( const dict_t* restrict dict, size_t* restrict bytes )
+dict_pool_t* dict_pool_create( dict_alloc_t alloc )
 {
-    size_t space;
-    if ( bytes == NULL )
+    dict_alloc_t base = dict_alloc_init( alloc, &alloc );
+    dict_pool_t* pool = base.alloc( base.ctx, sizeof (dict_pool_t), alignof (dict_pool_t) );
+    if ( pool == NULL ) return NULL;
+    pool->alloc = dict_alloc_init( alloc, &pool->alloc );
+    pool->len   = 0;
+    pool->mod   = POOL_MOD;
+    pool->slots = pool->alloc.alloc( pool->alloc.ctx, sizeof (dict_intern_t*) * pool->mod, alignof (dict_intern_t*) );
+    if ( pool->slots == NULL )
     {
-        bytes = &space;
+        base.dealloc( base.ctx, pool, sizeof (dict_pool_t) );
+        return NULL;
     }
+    memset( pool->slots, 0, sizeof (dict_intern_t*) * pool->mod );
+    pthread_mutex_init( &pool->lock, NULL );
+    return pool;
+}
 
-    // calculate key size and val size
-    uint32_t size = dict_len( dict );
-    uint32_t key_val_size[3] = { dict->key.size, dict->val.size, size };
-    size_t   elem_size = dict->key.type == DICT_STR ? sizeof (uint32_t) + dict->val.size : dict->key.size + dict->val.size;
 
-    // calculate total size
-    if ( dict->key.type == DICT_STR )
+void dict_pool_destroy( dict_pool_t* restrict pool )
+{
+    for ( size_t i = 0; i < pool->mod; i++ )
+    {
+        dict_intern_t* next;
+        for ( dict_intern_t* curr = pool->slots[i]; curr != NULL; curr = next )
+        {
+            next = curr->next;
+            pool->alloc.dealloc( pool->alloc.ctx, curr, sizeof (dict_intern_t) + curr->length + 1 );
+        }
+    }
+    pool->alloc.dealloc( pool->alloc.ctx, pool->slots, sizeof (dict_intern_t*) * pool->mod );
+    pthread_mutex_destroy( &pool->lock );
+
+    // `alloc` may point into the pool
+    dict_alloc_t alloc = pool->alloc;
+    if ( alloc.ctx == &pool->alloc ) alloc.ctx = &alloc;
+    alloc.dealloc( alloc.ctx, pool, sizeof (dict_pool_t) );
+}
+
+
+const char* dict_pool_intern( dict_pool_t* restrict pool, const char* restrict str )
+{
+    return dict_pool_acquire( pool, str, dict_mix( dict_hash_str( str ) ) );
+}
+
+
+void dict_pool_release( dict_pool_t* restrict pool, const char* restrict str )
+{
+    dict_intern_t* intern = dict_pool_entry( str );
+    pthread_mutex_lock( &pool->lock );
+    if ( --intern->refs == 0 )
+    {
+        dict_intern_t** link = &pool->slots[ intern->code & ( pool->mod - 1 ) ];
+        while ( *link != intern )
+        {
+            link = &( *link )->next;
+        }
+        *link = intern->next;
+        pool->len--;
+        pool->alloc.dealloc( pool->alloc.ctx, intern, sizeof (dict_intern_t) + intern->length + 1 );
+    }
+    pthread_mutex_unlock( &pool->lock );
+}
+
+
+uint64_t dict_pool_hash( const char* restrict str )
+{
+    return dict_pool_entry( str )->code;
+}
+
+
+size_t dict_pool_length( const char* restrict str )
+{
+    return dict_pool_entry( str )->length;
+}
+
+
+size_t dict_pool_len( dict_pool_t* restrict pool )
+{
+    pthread_mutex_lock( &pool->lock );
+    size_t len = pool->len;
+    pthread_mutex_unlock( &pool->lock );
+    return len;
+}
+
+
+// length of a DICT_STR key, kept by the pool for pooled keys
+static inline size_t dict_key_length( const dict_t* restrict dict, const char* restrict str )
+{
+    return dict->key.pool != NULL ? dict_pool_length( str ) : strlen( str );
+}
+
+
+// `code` is only used to intern the key in a pool
+static inline void dict_copy_key( const dict_t* restrict dict, void* restrict dest, const void* restrict key, uint64_t code )
+{
+    if ( dict->key.copy != NULL )
+    {
+        dict->key.copy( dest, key );
+    }
+    else if ( dict->key.pool != NULL )
+    {
+        *(const char**) dest = dict_pool_acquire( dict->key.pool, *(char**) key, code );
+        ASSERT_MEM( *(char**) dest );
+    }
+    else if ( dict->key.type == DICT_STR )
     {
-        *bytes = sizeof (uint32_t) * 3 + size * elem_size;
+        const char* str = *(char**) key;
+        size_t length = strlen( str ) + 1;
+        *(char**) dest = dict_alloc_mem( dict, length );
+        ASSERT_MEM( *(char**) dest );
+        memcpy( *(char**) dest, str, length );
     }
     else
     {
-        *bytes = sizeof (uint32_t) * 3 + size * elem_size;
+        memcpy( dest, key, dict->key.size );
     }
+}
 
-    // calculate key size if string type
-    #ifdef __STDC_NO_VLA__
-        uint32_t* strlen_table;
-        if (dict->key.type == DICT_STR )
-        {
-            strlen_table = dict->alloc.malloc( sizeof (uint32_t) * size );
-            ASSERT_MEM( strlen_table );
-        }
-    #else
-        uint32_t strlen_table[size];
-    #endif  // __STDC_NO_VLA__
-    if ( dict->key.type == DICT_STR )
+
+static inline void dict_free_key( const dict_t* restrict dict, void* restrict key )
+{
+    if ( dict->key.copy != NULL && dict->key.free != NULL )
     {
-        size_t index = 0;
-        for ( size_t i = 0; i < dict->mod; i++ )
-        {
-            for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
-            {
-                strlen_table[index] = (uint32_t) strlen( *(char**) curr->key );
-                *bytes += strlen_table[index];
-                index++;
-            }
-        }
+        dict->key.free( key );
+    }
+    else if ( dict->key.pool != NULL )
+    {
+        dict_pool_release( dict->key.pool, *(char**) key );
+    }
+    else if ( dict->key.type == DICT_STR )
+    {
+        dict_free_mem( dict, *(char**) key, strlen( *(char**) key ) + 1 );
     }
+}
 
 
-    // allocate memory
-    void* data = dict->alloc.malloc( *bytes );
-    if ( data == NULL )
+static inline void dict_free_val( const dict_t* restrict dict, void* restrict val )
+{
+    if ( dict->val.free != NULL )
     {
-        *bytes = 0;
-        return NULL;
+        dict->val.free( val );
     }
-    char* ptr = data;
+}
 
-    // store header
-    memcpy( ptr, key_val_size, sizeof (uint32_t) * 3 );
-    ptr += sizeof (uint32_t) * 3;
 
-    // store individual items
+static inline void dict_free_node( const dict_t* restrict dict, dict_elem_t* restrict node )
+{
+    dict_free_mem( dict, node, dict->node_size );
+}
+
+
+static inline void dict_delete_node( dict_list_t* restrict list, dict_elem_t* restrict curr )
+{
+    // `curr->next` is left as it is for readers still standing on `curr`
+    if ( curr == list->head )
+    {
+        dict_store( &list->head, curr->next );
+    }
+    if ( curr == list->tail )
+    {
+        list->tail = curr->prev;
+    }
+    if ( curr->prev != NULL )
+    {
+        dict_store( &curr->prev->next, curr->next );
+    }
+    if ( curr->next != NULL )
+    {
+        curr->next->prev = curr->prev;
+    }
+    list->size--;
+}
+
+
+// order of two keys with the same hash code, only defined when keys are compared without `key.cmpr`
+static inline int dict_key_order( const dict_t* restrict dict, const void* key1, const void* key2 )
+{
     if ( dict->key.type == DICT_STR )
     {
-        size_t index = 0;
-        char* str_ptr = ptr + size * elem_size;
-        for ( size_t i = 0; i < dict->mod; i++ )
-        {
-            for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
-            {
-                memcpy( ptr, &strlen_table[index], sizeof (uint32_t) );
-                ptr += sizeof (uint32_t);
-                memcpy( ptr, curr->key + dict->key.size, dict->val.size );
-                ptr += dict->val.size;
-                memcpy( str_ptr, *(char**) curr->key, strlen_table[index] );
-                str_ptr += strlen_table[index];
-                index++;
-            }
-        }
+        return strcmp( *(char**) key1, *(char**) key2 );
     }
-    else
+    if ( dict->key.type == DICT_F32 || dict->key.type == DICT_F64 )
     {
-        for ( size_t i = 0; i < dict->mod; i++ )
-        {
-            for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
-            {
-                memcpy( ptr, curr->key, elem_size );
-                ptr += elem_size;
-            }
-        }
+        uint64_t bits1 = dict_float_bits( dict, key1 );
+        uint64_t bits2 = dict_float_bits( dict, key2 );
+        return ( bits1 > bits2 ) - ( bits1 < bits2 );
     }
+    return memcmp( key1, key2, dict->key.size );
+}
 
-    // clean up memory allocation
-    #ifdef __STDC_NO_VLA__
-        if ( dict->key.type != DICT_STR && dict->alloc.free != NULL )
+
+// first of the `len` nodes of the bin not ordered before `code` and `key`. With `key.cmpr` only the codes are ordered
+static inline size_t dict_bin_search( const dict_t* restrict dict, dict_elem_t* const* bin, size_t len, const void* key, uint64_t code )
+{
+    size_t lo = 0;
+    size_t hi = len;
+    while ( lo < hi )
+    {
+        size_t mid = lo + ( hi - lo ) / 2;
+        if ( bin[mid]->code < code || ( bin[mid]->code == code && dict->key.cmpr == NULL && dict_key_order( dict, bin[mid]->key, key ) < 0 ) )
         {
-            dict->alloc.free( strlen_table );
+            lo = mid + 1;
         }
-    #endif  // __STDC_NO_VLA__
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
 
-    return data;
+
+// place a node into the bin which holds the other `len` nodes of the chain
+static inline void dict_bin_insert( const dict_t* restrict dict, dict_list_t* restrict list, size_t len, dict_elem_t* restrict elem )
+{
+    if ( len == list->cap )
+    {
+        dict_elem_t** bin = dict_realloc_mem( dict, list->bin, sizeof (dict_elem_t*) * list->cap, sizeof (dict_elem_t*) * list->cap * DEFAULT_STEP );
+        ASSERT_MEM( bin );
+        list->bin = bin;
+        list->cap *= DEFAULT_STEP;
+    }
+
+    size_t pos = dict_bin_search( dict, list->bin, len, elem->key, elem->code );
+    memmove( &list->bin[ pos + 1 ], &list->bin[ pos ], sizeof (dict_elem_t*) * ( len - pos ) );
+    list->bin[ pos ] = elem;
 }
 
 
-dict_t* dict_deserialize( dict_args_t args, const void* restrict data )
+static inline void dict_bin_build( const dict_t* restrict dict, dict_list_t* restrict list )
 {
-    const char* ptr = data;
-    uint32_t key_val_size[3];
-    memcpy( key_val_size, ptr, sizeof (uint32_t) * 3 );
-    ptr += sizeof (uint32_t) * 3;
+    list->cap = list->size * DEFAULT_STEP;
+    list->bin = dict_alloc_mem( dict, sizeof (dict_elem_t*) * list->cap );
+    ASSERT_MEM( list->bin );
 
-    size_t key_size;
-    switch ( args.key.type )
-    {
-        case DICT_CHAR:    key_size = sizeof ( char );                      break;
-        case DICT_WCHAR:   key_size = sizeof ( wchar_t );                   break;
-        case DICT_I32:     key_size = sizeof ( int32_t );                   break;
-        case DICT_U32:     key_size = sizeof ( uint32_t );                  break;
-        case DICT_F32:     key_size = sizeof ( float );                     break;
-        case DICT_I64:     key_size = sizeof ( int64_t );                   break;
-        case DICT_U64:     key_size = sizeof ( uint64_t );                  break;
-        case DICT_F64:     key_size = sizeof ( double );                    break;
-        case DICT_PTR:     key_size = sizeof ( void* );                     break;
-        case DICT_STR:     key_size = sizeof ( char* );                     break;
-        case DICT_STRUCT:
-        {
-            key_size = ( args.key.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
-            break;
-        }
-        default:           fprintf( stderr, "[ERRO]: illegal type.\n" );    exit(1);
+    size_t len = 0;
+    for ( dict_elem_t* curr = list->head; curr != NULL; curr = curr->next )
+    {
+        dict_bin_insert( dict, list, len++, curr );
     }
+}
 
-    size_t val_size = ( args.val.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
 
-    if ( key_size != key_val_size[0] )
+static inline void dict_bin_free( const dict_t* restrict dict, dict_list_t* restrict list )
+{
+    if ( list->bin != NULL )
     {
-        fprintf( stderr, "[ERRO]: key type conflict, data corrupted.\n" );
-        return NULL;
+        dict_free_mem( dict, list->bin, sizeof (dict_elem_t*) * list->cap );
     }
+    list->bin = NULL;
+    list->cap = 0;
+}
+
 
-    if ( val_size != key_val_size[1] )
+// keep the bin in step with a node just appended to the chain
+static inline void dict_bin_add( const dict_t* restrict dict, dict_list_t* restrict list, dict_elem_t* restrict elem )
+{
+    if ( list->bin != NULL )
     {
-        fprintf( stderr, "[ERRO]: val type conflict, data corrupted.\n" );
-        return NULL;
+        dict_bin_insert( dict, list, list->size - 1, elem );
+    }
+    else if ( list->size >= BIN_MIN && list != &dict->small )
+    {
+        dict_bin_build( dict, list );
     }
+}
+
+
+// keep the bin in step with a node just deleted from the chain, the bin is dropped once the chain got short
+static inline void dict_bin_remove( const dict_t* restrict dict, dict_list_t* restrict list, dict_elem_t* restrict elem )
+{
+    if ( list->bin == NULL ) return;
 
-    dict_t* dict = NULL;
-    if ( args.alloc.malloc != NULL )
+    if ( list->size < BIN_DROP )
     {
-        dict = args.alloc.malloc( sizeof (dict_t) );
-        ASSERT_MEM( dict );
-        dict->alloc = args.alloc;
+        dict_bin_free( dict, list );
+        return;
     }
-    else
+
+    size_t pos = dict_bin_search( dict, list->bin, list->size + 1, elem->key, elem->code );
+    while ( list->bin[ pos ] != elem )
     {
-        dict = malloc( sizeof (dict_t) );
-        ASSERT_MEM( dict );
-        dict->alloc = (dict_alloc_t)
-        {
-            .malloc = malloc,
-            .free   = free,
-        };
+        pos++;
     }
+    memmove( &list->bin[ pos ], &list->bin[ pos + 1 ], sizeof (dict_elem_t*) * ( list->size - pos ) );
+}
 
-    dict->key = args.key;
-    dict->key.size = key_size;
 
-    dict->val = args.val;
-    dict->val.size = val_size;
+// split block bloom filter, every key sets one bit in each word of a single cache line
+static const uint32_t dict_filter_salt[8] =
+{
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
 
-    dict->key_temp = dict->alloc.malloc( dict->key.size );
-    ASSERT_MEM( dict->key_temp );
 
-    dict->mod = DEFAULT_MOD;
-    dict->list  = dict->alloc.malloc( sizeof (dict_list_t) * dict->mod );
-    ASSERT_MEM( dict->list );
-    memset( dict->list, 0, sizeof (dict_list_t) * dict->mod );
+static inline uint64_t* dict_filter_block( const dict_t* restrict dict, uint64_t hash )
+{
+    return dict->filter.data + ( ( ( hash >> 32 ) * dict->filter.blocks ) >> 32 ) * 8;
+}
+
 
-    // assign all the values
-    size_t elem_size = dict->key.type == DICT_STR ? sizeof (uint32_t) + dict->val.size : dict->key.size + dict->val.size;
-    size_t index;
-    uint64_t code;
-    dict_elem_t* elem;
-    if ( dict->key.type == DICT_STR )
+static inline void dict_filter_add( dict_t* restrict dict, uint64_t code )
+{
+    uint64_t  hash  = dict_mix( code );
+    uint64_t* block = dict_filter_block( dict, hash );
+    for ( size_t i = 0; i < 8; i++ )
     {
-        const char* str_ptr = ptr + key_val_size[2] * elem_size;
-        for ( size_t i = 0; i < key_val_size[2]; i++ )
+        block[i] |= 1LLU << ( ( (uint32_t) hash * dict_filter_salt[i] ) >> 26 );
+    }
+}
+
+
+static inline bool dict_filter_may_have( const dict_t* restrict dict, uint64_t code )
+{
+    uint64_t  hash  = dict_mix( code );
+    uint64_t* block = dict_filter_block( dict, hash );
+    for ( size_t i = 0; i < 8; i++ )
+    {
+        if ( ( block[i] & ( 1LLU << ( ( (uint32_t) hash * dict_filter_salt[i] ) >> 26 ) ) ) == 0 )
         {
-            elem = dict->alloc.malloc( sizeof (dict_elem_t) + dict->key.size + dict->val.size );
-            ASSERT_MEM( elem );
-            // copy string
-            *(char**) elem->key = dict->alloc.malloc( *(uint32_t*) ptr + 1 );
-            ASSERT_MEM( elem->key );
-            memcpy( *(char**) elem->key, str_ptr, *(uint32_t*) ptr );
-            ( *(char**) elem->key )[ *(uint32_t*) ptr ] = 0;
-            str_ptr += *(uint32_t*) ptr;
-            ptr += sizeof (uint32_t);
-            memcpy( elem->key + dict->key.size, ptr, dict->val.size );
-            ptr += dict->val.size;
-            code = dict_get_hash( dict, elem->key );
-            elem->code = code;
-            index = code % dict->mod;
-            elem->prev = dict->list[index].tail;
-            elem->next = NULL;
-            if ( dict->list[index].size++ == 0 )
-            {
-                dict->list[index].head = dict->list[index].tail = elem;
-            }
-            else 
-            {
-                dict->list[index].tail->next = elem;
-                dict->list[index].tail = elem;
-            }
+            return false;
         }
     }
-    else 
+    return true;
+}
+
+
+// the allocator may ignore the alignment, so a spare line is allocated to align the blocks by hand
+static inline size_t dict_filter_bytes( size_t blocks )
+{
+    return blocks * FILTER_LINE + FILTER_LINE - 1;
+}
+
+
+// size the filter for twice the current amount of keys, and drop the bits of removed keys
+static inline bool dict_filter_rebuild( dict_t* restrict dict )
+{
+    size_t capacity = dict->len * 2 < FILTER_MIN ? FILTER_MIN : dict->len * 2;
+    size_t blocks   = ( capacity * dict->filter.bits + FILTER_LINE * 8 - 1 ) / ( FILTER_LINE * 8 );
+
+    void* raw = dict->alloc.alloc( dict->alloc.ctx, dict_filter_bytes( blocks ), FILTER_LINE );
+    if ( raw == NULL ) return false;
+
+    if ( dict->filter.raw != NULL )
+    {
+        dict_free_mem( dict, dict->filter.raw, dict_filter_bytes( dict->filter.blocks ) );
+    }
+    dict->filter.raw      = raw;
+    dict->filter.data     = (uint64_t*) ( ( (uintptr_t) raw + FILTER_LINE - 1 ) & ~(uintptr_t) ( FILTER_LINE - 1 ) );
+    dict->filter.blocks   = blocks;
+    dict->filter.capacity = capacity;
+    dict->filter.removed  = 0;
+    memset( dict->filter.data, 0, blocks * FILTER_LINE );
+
+    for ( size_t i = 0; i < dict->mod; i++ )
     {
-        for ( size_t i = 0; i < key_val_size[2]; i++ )
+        for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
         {
-            elem = dict->alloc.malloc( sizeof (dict_elem_t) + dict->key.size + dict->val.size );
-            ASSERT_MEM( elem );
-            memcpy( elem->key, ptr, elem_size );
-            ptr += elem_size;
-            code = dict_get_hash( dict, elem->key );
-            elem->code = code;
-            index = code % dict->mod;
-            elem->prev = dict->list[index].tail;
-            elem->next = NULL;
-            if ( dict->list[index].size++ == 0 )
-            {
-                dict->list[index].head = dict->list[index].tail = elem;
-            }
-            else
-            {
-                dict->list[index].tail->next = elem;
-                dict->list[index].tail = elem;
-            }
+            dict_filter_add( dict, curr->code );
         }
     }
+    return true;
+}
 
-    size_t max = 0;
-    for ( size_t i = 0; i < dict->mod; i++ )
+
+// position of an integer key, ordered the same way as the key itself
+static inline uint64_t dict_dense_pos( const dict_t* restrict dict, const void* restrict key )
+{
+    switch ( dict->key.type )
     {
-        if ( dict->list[i].size > max )
+        case DICT_CHAR:         return (uint64_t) (int64_t) *(char*)    key ^ SIGN_BIT;
+        case DICT_WCHAR:        return (uint64_t) (int64_t) *(wchar_t*) key ^ SIGN_BIT;
+        case DICT_I32:          return (uint64_t) (int64_t) *(int32_t*) key ^ SIGN_BIT;
+        case DICT_I64:          return (uint64_t) *(int64_t*) key ^ SIGN_BIT;
+        case DICT_U32:          return *(uint32_t*) key;
+        case DICT_U64:          return *(uint64_t*) key;
+        default:
         {
-            max = dict->list[i].size;
+            fprintf( stderr, "[ERRO]: illegal type.\n" );
+            exit(1);
         }
     }
+}
+
+
+// whether `count` keys spread over positions [lo, lo + extent] are dense enough for direct indexing
+static inline bool dict_dense_fits( const dict_t* restrict dict, size_t count, uint64_t extent )
+{
+    if ( extent < DENSE_MIN_SPAN ) return true;
+    if ( extent >= SIZE_MAX / ( dict->key.size + dict->val.size ) / 2 ) return false;
+    return (double) count >= dict->dense.fill * ( (double) extent + 1 );
+}
+
+
+static inline bool dict_dense_test( const dict_t* restrict dict, uint64_t slot )
+{
+    return ( dict->dense.bits[ slot / 64 ] >> ( slot % 64 ) ) & 1;
+}
+
+
+static inline char* dict_dense_slot( const dict_t* restrict dict, uint64_t slot )
+{
+    return dict->dense.data + slot * ( dict->key.size + dict->val.size );
+}
+
+
+static inline void dict_dense_track( dict_t* restrict dict, const void* restrict key )
+{
+    uint64_t pos = dict_dense_pos( dict, key );
+    if ( pos < dict->dense.lo ) dict->dense.lo = pos;
+    if ( pos > dict->dense.hi ) dict->dense.hi = pos;
+}
+
 
-    if ( max <= DEFAULT_MOD ) return dict;
-    max /= DEFAULT_MOD;
-    if ( dict_reshape( dict, max ) == false )
+static inline void dict_dense_release( dict_t* restrict dict )
+{
+    if ( dict->dense.span != 0 )
     {
-        return NULL;
+        dict_free_mem( dict, dict->dense.data, ( dict->key.size + dict->val.size ) * dict->dense.span );
+        dict_free_mem( dict, dict->dense.bits, sizeof (uint64_t) * ( ( dict->dense.span + 63 ) / 64 ) );
     }
-    return dict;
+    dict->dense.data = NULL;
+    dict->dense.bits = NULL;
+    dict->dense.span = 0;
+}
+
+
+// rebuild the slot array so that it covers [base, base + span)
+static inline bool dict_dense_resize( dict_t* restrict dict, uint64_t base, size_t span )
+{
+    size_t stride = dict->key.size + dict->val.size;
+    size_t words  = ( span + 63 ) / 64;
+
+    char*     data = dict_alloc_mem( dict, stride * span );
+    uint64_t* bits = dict_alloc_mem( dict, sizeof (uint64_t) * words );
+    if ( data == NULL || bits == NULL )
+    {
+        if ( data != NULL ) dict_free_mem( dict, data, stride * span );
+        if ( bits != NULL ) dict_free_mem( dict, bits, sizeof (uint64_t) * words );
+        return false;
+    }
+    memset( bits, 0, sizeof (uint64_t) * words );
+
+    for ( size_t i = 0; i < dict->dense.span; i++ )
+    {
+        if ( dict_dense_test( dict, i ) == false ) continue;
+        uint64_t slot = dict->dense.base + i - base;
+        memcpy( data + slot * stride, dict_dense_slot( dict, i ), stride );
+        bits[ slot / 64 ] |= 1LLU << ( slot % 64 );
+    }
+
+    dict_dense_release( dict );
+    dict->dense.base = base;
+    dict->dense.span = span;
+    dict->dense.data = data;
+    dict->dense.bits = bits;
+    return true;
+}
+
+
+static inline bool dict_dense_cover( dict_t* restrict dict, uint64_t lo, uint64_t hi )
+{
+    size_t span = hi - lo + 1;
+    if ( span < DENSE_MIN_SPAN )
+    {
+        span = DENSE_MIN_SPAN;
+    }
+    if ( lo > UINT64_MAX - ( span - 1 ) )
+    {
+        lo = UINT64_MAX - ( span - 1 );
+    }
+    return dict_dense_resize( dict, lo, span );
+}
+
+
+static inline dict_clock_t* dict_elem_clock( const dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    return (dict_clock_t*) ( elem->key + dict->cache.offset );
+}
+
+
+// memory charged to the byte budget for a pair
+static inline size_t dict_cache_cost( const dict_t* restrict dict, const void* restrict key )
+{
+    size_t cost = dict->node_size + ( dict->arena.enable ? dict->arena.slot : 0 );
+    if ( dict->key.type == DICT_STR && dict->key.copy == NULL )
+    {
+        cost += strlen( *(char**) key ) + 1;
+    }
+    return cost;
+}
+
+
+// new node goes right behind the hand, so it is the last one to be visited
+static inline void dict_cache_link( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_clock_t* clock = dict_elem_clock( dict, elem );
+    clock->ref = false;
+    if ( dict->cache.hand == NULL )
+    {
+        clock->prev = clock->next = elem;
+        dict->cache.hand = elem;
+    }
+    else
+    {
+        dict_elem_t* hand = dict->cache.hand;
+        clock->next = hand;
+        clock->prev = dict_elem_clock( dict, hand )->prev;
+        dict_elem_clock( dict, clock->prev )->next = elem;
+        dict_elem_clock( dict, hand )->prev = elem;
+    }
+    dict->cache.bytes += dict_cache_cost( dict, elem->key );
+}
+
+
+static inline void dict_cache_unlink( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_clock_t* clock = dict_elem_clock( dict, elem );
+    if ( clock->next == elem )
+    {
+        dict->cache.hand = NULL;
+    }
+    else
+    {
+        dict_elem_clock( dict, clock->prev )->next = clock->next;
+        dict_elem_clock( dict, clock->next )->prev = clock->prev;
+        if ( dict->cache.hand == elem )
+        {
+            dict->cache.hand = clock->next;
+        }
+    }
+    dict->cache.bytes -= dict_cache_cost( dict, elem->key );
+}
+
+
+// the only work done on a hit
+static inline void dict_cache_touch( const dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    if ( dict->cache.enable )
+    {
+        dict_elem_clock( dict, elem )->ref = true;
+    }
+}
+
+
+static uint64_t dict_ttl_clock( void* ctx )
+{
+    (void) ctx;
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+
+static inline dict_expiry_t* dict_elem_expiry( const dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    return (dict_expiry_t*) ( elem->key + dict->ttl.offset );
+}
+
+
+static inline void dict_ttl_push( dict_t* restrict dict, dict_elem_t* restrict elem, uint32_t where )
+{
+    dict_expiry_t* expiry = dict_elem_expiry( dict, elem );
+    expiry->where = where;
+    expiry->prev  = NULL;
+    expiry->next  = dict->ttl.slots[ where ];
+    if ( expiry->next != NULL )
+    {
+        dict_elem_expiry( dict, expiry->next )->prev = elem;
+    }
+    dict->ttl.slots[ where ] = elem;
+    if ( where < TTL_DUE )
+    {
+        dict->ttl.bits[ where / TTL_SLOTS ] |= 1LLU << ( where % TTL_SLOTS );
+    }
+}
+
+
+// put a node with a deadline in the list matching it
+static inline void dict_ttl_place( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    uint64_t deadline = dict_elem_expiry( dict, elem )->deadline;
+    uint64_t diff     = deadline ^ dict->ttl.tick;
+    if ( deadline <= dict->ttl.tick )
+    {
+        dict_ttl_push( dict, elem, TTL_DUE );
+        return;
+    }
+    if ( diff >> TTL_SPAN != 0 )
+    {
+        dict_ttl_push( dict, elem, TTL_FAR );
+        return;
+    }
+    uint32_t level = 0;
+    while ( diff >> ( TTL_BITS * ( level + 1 ) ) != 0 )
+    {
+        level++;
+    }
+    dict_ttl_push( dict, elem, level * TTL_SLOTS + ( ( deadline >> ( TTL_BITS * level ) ) & ( TTL_SLOTS - 1 ) ) );
+}
+
+
+static inline void dict_ttl_unlink( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_expiry_t* expiry = dict_elem_expiry( dict, elem );
+    if ( expiry->deadline == 0 ) return;
+
+    if ( expiry->prev != NULL )
+    {
+        dict_elem_expiry( dict, expiry->prev )->next = expiry->next;
+    }
+    else
+    {
+        dict->ttl.slots[ expiry->where ] = expiry->next;
+        if ( expiry->next == NULL && expiry->where < TTL_DUE )
+        {
+            dict->ttl.bits[ expiry->where / TTL_SLOTS ] &= ~( 1LLU << ( expiry->where % TTL_SLOTS ) );
+        }
+    }
+    if ( expiry->next != NULL )
+    {
+        dict_elem_expiry( dict, expiry->next )->prev = expiry->prev;
+    }
+    expiry->deadline = 0;
+    dict->ttl.count--;
+}
+
+
+static inline void dict_ttl_set( dict_t* restrict dict, dict_elem_t* restrict elem, uint64_t deadline )
+{
+    dict_ttl_unlink( dict, elem );
+    if ( deadline == 0 ) return;
+    dict_elem_expiry( dict, elem )->deadline = deadline;
+    dict_ttl_place( dict, elem );
+    dict->ttl.count++;
+}
+
+
+// arm a pair merged from `src` with the time it had left there, the deadline itself if both dicts read the same clock
+static inline void dict_ttl_carry( dict_t* restrict dst, const dict_t* restrict src, dict_elem_t* restrict elem, uint64_t deadline )
+{
+    if ( deadline == 0 || dst->ttl.enable == false ) return;
+    if ( dst->ttl.now != src->ttl.now || dst->ttl.ctx != src->ttl.ctx )
+    {
+        uint64_t now  = src->ttl.now( src->ttl.ctx );
+        uint64_t left = deadline > now ? deadline - now : 0;
+        deadline = dst->ttl.now( dst->ttl.ctx ) + left;
+        deadline = deadline != 0 ? deadline : 1;
+    }
+    dict_ttl_set( dst, elem, deadline );
+}
+
+
+// first time after `tick` where a slot of the wheel has to be emptied, UINT64_MAX if none
+static inline uint64_t dict_ttl_next( const dict_t* restrict dict )
+{
+    uint64_t next = UINT64_MAX;
+    uint64_t tick = dict->ttl.tick;
+    for ( uint32_t level = 0; level < TTL_LEVELS; level++ )
+    {
+        uint32_t shift = TTL_BITS * level;
+        uint64_t ahead = dict->ttl.bits[ level ] & ~( ( 2LLU << ( ( tick >> shift ) & ( TTL_SLOTS - 1 ) ) ) - 1 );
+        if ( ahead == 0 ) continue;
+        uint64_t slot = 0;
+        while ( ( ahead >> slot & 1 ) == 0 )
+        {
+            slot++;
+        }
+        uint64_t at = ( tick >> ( shift + TTL_BITS ) << ( shift + TTL_BITS ) ) | ( slot << shift );
+        next = at < next ? at : next;
+    }
+    if ( dict->ttl.slots[ TTL_FAR ] != NULL )
+    {
+        uint64_t at = ( ( tick >> TTL_SPAN ) + 1 ) << TTL_SPAN;
+        next = at < next ? at : next;
+    }
+    return next;
+}
+
+
+// move every node of a list into the one matching it as of the current `tick`
+static inline void dict_ttl_cascade( dict_t* restrict dict, uint32_t where )
+{
+    dict_elem_t* elem = dict->ttl.slots[ where ];
+    dict->ttl.slots[ where ] = NULL;
+    if ( where < TTL_DUE )
+    {
+        dict->ttl.bits[ where / TTL_SLOTS ] &= ~( 1LLU << ( where % TTL_SLOTS ) );
+    }
+    while ( elem != NULL )
+    {
+        dict_elem_t* next = dict_elem_expiry( dict, elem )->next;
+        dict_ttl_place( dict, elem );
+        elem = next;
+    }
+}
+
+
+// advance the wheel to `now`, jumping straight from one non-empty slot to the next, expired nodes end up in the due list
+static inline void dict_ttl_advance( dict_t* restrict dict, uint64_t now )
+{
+    while ( dict->ttl.tick < now )
+    {
+        uint64_t next = dict_ttl_next( dict );
+        if ( next > now )
+        {
+            dict->ttl.tick = now;
+            return;
+        }
+        dict->ttl.tick = next;
+        if ( ( next & ( ( 1LLU << TTL_SPAN ) - 1 ) ) == 0 )
+        {
+            dict_ttl_cascade( dict, TTL_FAR );
+        }
+        for ( uint32_t level = TTL_LEVELS; level-- > 0; )
+        {
+            uint32_t shift = TTL_BITS * level;
+            if ( ( next & ( ( 1LLU << shift ) - 1 ) ) == 0 )
+            {
+                dict_ttl_cascade( dict, level * TTL_SLOTS + ( ( next >> shift ) & ( TTL_SLOTS - 1 ) ) );
+            }
+        }
+    }
+}
+
+
+static inline bool dict_buffer_push( const dict_t* restrict dict, dict_buffer_t* restrict buffer, const void* restrict data, size_t size )
+{
+    if ( buffer->size + size > buffer->cap )
+    {
+        size_t cap = buffer->cap == 0 ? SNAPSHOT_FLUSH : buffer->cap;
+        while ( cap < buffer->size + size )
+        {
+            cap *= DEFAULT_STEP;
+        }
+        char* grow = dict_realloc_mem( dict, buffer->data, buffer->cap, cap );
+        if ( grow == NULL ) return false;
+        buffer->data = grow;
+        buffer->cap  = cap;
+    }
+    memcpy( buffer->data + buffer->size, data, size );
+    buffer->size += size;
+    return true;
+}
+
+
+static inline size_t* dict_elem_order( const dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    return (size_t*) ( elem->key + dict->order.offset );
+}
+
+
+// order of two keys for the ordered index, by `order.cmpr` or by natural order
+static inline int dict_order_cmpr( const dict_t* restrict dict, const void* key1, const void* key2 )
+{
+    if ( dict->order.cmpr != NULL )
+    {
+        return dict->order.cmpr( key1, key2 );
+    }
+    switch ( dict->key.type )
+    {
+        case DICT_CHAR:     return ORDER_OF( char, key1, key2 );
+        case DICT_WCHAR:    return ORDER_OF( wchar_t, key1, key2 );
+        case DICT_I32:      return ORDER_OF( int32_t, key1, key2 );
+        case DICT_U32:      return ORDER_OF( uint32_t, key1, key2 );
+        case DICT_F32:      return ORDER_OF( float, key1, key2 );
+        case DICT_I64:      return ORDER_OF( int64_t, key1, key2 );
+        case DICT_U64:      return ORDER_OF( uint64_t, key1, key2 );
+        case DICT_F64:      return ORDER_OF( double, key1, key2 );
+        case DICT_PTR:      return ORDER_OF( uintptr_t, key1, key2 );
+        case DICT_STR:      return strcmp( *(char**) key1, *(char**) key2 );
+        default:            return memcmp( key1, key2, dict->key_data );
+    }
+}
+
+
+// new nodes wait in `pending` until the next query sorts them in
+static inline void dict_order_add( dict_t* restrict dict, dict_elem_t* elem )
+{
+    *dict_elem_order( dict, elem ) = ( dict->order.pending.size / sizeof (dict_elem_t*) ) | ORDER_PENDING;
+    if ( dict_buffer_push( dict, &dict->order.pending, &elem, sizeof (dict_elem_t*) ) == false )
+    {
+        fprintf( stderr, "[ERRO]: out of memory.\n" );
+        exit(1);
+    }
+}
+
+
+static inline void dict_order_remove( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    size_t pos = *dict_elem_order( dict, elem );
+    if ( pos & ORDER_PENDING )
+    {
+        ( (dict_elem_t**) dict->order.pending.data )[ pos & ~ORDER_PENDING ] = NULL;
+    }
+    else
+    {
+        dict->order.items[ pos ] = NULL;
+    }
+    dict->order.removed++;
+}
+
+
+// merge sort, `temp` holds at least `len` nodes
+static void dict_order_sort( const dict_t* restrict dict, dict_elem_t** items, dict_elem_t** temp, size_t len )
+{
+    if ( len < 2 ) return;
+
+    size_t half = len / 2;
+    dict_order_sort( dict, items, temp, half );
+    dict_order_sort( dict, items + half, temp, len - half );
+    if ( dict_order_cmpr( dict, items[ half - 1 ]->key, items[ half ]->key ) <= 0 ) return;
+
+    memcpy( temp, items, sizeof (dict_elem_t*) * half );
+    size_t i = 0, j = half, k = 0;
+    while ( i < half && j < len )
+    {
+        items[ k++ ] = dict_order_cmpr( dict, temp[i]->key, items[j]->key ) <= 0 ? temp[ i++ ] : items[ j++ ];
+    }
+    while ( i < half )
+    {
+        items[ k++ ] = temp[ i++ ];
+    }
+}
+
+
+// drop the removed nodes and merge the pending ones into the sorted array
+static inline void dict_order_refresh( dict_t* restrict dict )
+{
+    dict_order_t* order = &dict->order;
+    if ( order->pending.size == 0 && order->removed == 0 ) return;
+
+    dict_elem_t** pending = (dict_elem_t**) order->pending.data;
+    size_t fresh = 0;
+    for ( size_t i = 0; i < order->pending.size / sizeof (dict_elem_t*); i++ )
+    {
+        if ( pending[i] != NULL ) pending[ fresh++ ] = pending[i];
+    }
+    size_t kept = 0;
+    for ( size_t i = 0; i < order->len; i++ )
+    {
+        if ( order->items[i] != NULL ) order->items[ kept++ ] = order->items[i];
+    }
+
+    dict_elem_t** items = dict_alloc_mem( dict, sizeof (dict_elem_t*) * ( kept + fresh + 1 ) );
+    ASSERT_MEM( items );
+    dict_order_sort( dict, pending, items, fresh );
+
+    size_t i = 0, j = 0, k = 0;
+    while ( i < kept && j < fresh )
+    {
+        items[ k++ ] = dict_order_cmpr( dict, order->items[i]->key, pending[j]->key ) <= 0 ? order->items[ i++ ] : pending[ j++ ];
+    }
+    while ( i < kept )  items[ k++ ] = order->items[ i++ ];
+    while ( j < fresh ) items[ k++ ] = pending[ j++ ];
+    for ( k = 0; k < kept + fresh; k++ )
+    {
+        *dict_elem_order( dict, items[k] ) = k;
+    }
+
+    if ( order->items != NULL )
+    {
+        dict_free_mem( dict, order->items, sizeof (dict_elem_t*) * ( order->len + 1 ) );
+    }
+    order->items        = items;
+    order->len          = kept + fresh;
+    order->pending.size = 0;
+    order->removed      = 0;
+}
+
+
+// first position of the index not ordered before `key`
+static inline size_t dict_order_search( const dict_t* restrict dict, const void* restrict key )
+{
+    size_t lo = 0;
+    size_t hi = dict->order.len;
+    while ( lo < hi )
+    {
+        size_t mid = lo + ( hi - lo ) / 2;
+        if ( dict_order_cmpr( dict, dict->order.items[ mid ]->key, key ) < 0 )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+// encode a pair the same way as `dict_serialize`, the lock of the snapshot must be held
+static inline void dict_snapshot_item( dict_snapshot_t* restrict snap, const char* restrict item )
+{
+    const dict_t* dict = snap->dict;
+    bool ok;
+    if ( dict->key.type == DICT_STR )
+    {
+        uint32_t length = (uint32_t) dict_key_length( dict, *(char**) item );
+        ok = dict_buffer_push( dict, &snap->items, &length, sizeof (uint32_t) ) &&
+             dict_buffer_push( dict, &snap->items, dict_item_val( dict, item ), dict->val.size ) &&
+             dict_buffer_push( dict, &snap->strs, *(char**) item, length );
+    }
+    else
+    {
+        ok = dict_buffer_push( dict, &snap->items, item, dict->key.size ) &&
+             dict_buffer_push( dict, &snap->items, dict_item_val( dict, item ), dict->val.size );
+    }
+    if ( ok == false )
+    {
+        snap->failed = true;
+    }
+}
+
+
+static inline void dict_snapshot_copy( dict_snapshot_t* restrict snap, size_t index )
+{
+    for ( dict_elem_t* curr = snap->dict->list[ index ].head; curr != NULL; curr = curr->next )
+    {
+        dict_snapshot_item( snap, curr->key );
+    }
+    atomic_store_explicit( &snap->done[ index ], 1, memory_order_release );
+}
+
+
+// copy the bucket into the snapshot before it gets modified
+static inline void dict_snapshot_touch( const dict_t* restrict dict, size_t index )
+{
+    dict_snapshot_t* snap = dict->snap;
+    if ( snap == NULL || atomic_load_explicit( &snap->done[ index ], memory_order_acquire ) ) return;
+
+    pthread_mutex_lock( &snap->lock );
+    if ( atomic_load_explicit( &snap->done[ index ], memory_order_relaxed ) == 0 )
+    {
+        dict_snapshot_copy( snap, index );
+    }
+    pthread_mutex_unlock( &snap->lock );
+}
+
+
+static inline bool dict_log_write( dict_t* restrict dict )
+{
+    dict_log_t* log = dict->log;
+    if ( log->records.size == 0 ) return log->failed == false;
+
+    if ( fwrite( log->records.data, 1, log->records.size, log->fp ) != log->records.size ||
+         fflush( log->fp ) != 0 || dict_fsync( log->fp ) != 0 )
+    {
+        log->failed = true;
+    }
+    log->records.size = 0;
+    return log->failed == false;
+}
+
+
+// record layout: op, length of the key in bytes, key, and val for LOG_PUT
+static inline void dict_log_record( dict_t* restrict dict, uint8_t op, const char* restrict item )
+{
+    dict_log_t* log = dict->log;
+    const void* key = item;
+    uint32_t    length = dict->key.size;
+    if ( dict->key.type == DICT_STR )
+    {
+        key    = *(char**) item;
+        length = (uint32_t) strlen( key );
+    }
+
+    if ( dict_buffer_push( dict, &log->records, &op, sizeof (uint8_t) ) == false ||
+         dict_buffer_push( dict, &log->records, &length, sizeof (uint32_t) ) == false ||
+         dict_buffer_push( dict, &log->records, key, length ) == false ||
+         ( op == LOG_PUT && dict_buffer_push( dict, &log->records, dict_item_val( dict, item ), dict->val.size ) == false ) )
+    {
+        log->failed = true;
+    }
+
+    // group commit
+    if ( log->records.size >= log->batch )
+    {
+        dict_log_write( dict );
+    }
+}
+
+
+// the val handed out by the last call may have been modified since, log it if so
+static inline void dict_log_pending( dict_t* restrict dict )
+{
+    dict_log_t* log = dict->log;
+    if ( log == NULL || log->item == NULL ) return;
+
+    if ( log->inserted || memcmp( log->before, dict_item_val( dict, log->item ), dict->val.size ) != 0 )
+    {
+        dict_log_record( dict, LOG_PUT, log->item );
+    }
+    log->item = NULL;
+}
+
+
+static inline void dict_log_hand( dict_t* restrict dict, void* restrict val, bool inserted )
+{
+    dict_log_t* log = dict->log;
+    if ( log == NULL || val == NULL ) return;
+
+    log->item     = dict_val_item( dict, val );
+    log->inserted = inserted;
+    memcpy( log->before, val, dict->val.size );
+}
+
+
+// free what was retired before the oldest read section still running
+static inline void dict_swmr_reclaim( dict_t* restrict dict )
+{
+    dict_swmr_t* swmr = &dict->swmr;
+
+    // a reader that begins from now on can not reach anything retired so far
+    uint64_t oldest = atomic_fetch_add( &swmr->epoch, 1 ) + 1;
+    atomic_thread_fence( memory_order_seq_cst );
+    pthread_mutex_lock( &swmr->lock );
+    for ( dict_reader_t* reader = swmr->readers; reader != NULL; reader = reader->next )
+    {
+        uint64_t epoch = atomic_load_explicit( &reader->epoch, memory_order_acquire );
+        if ( epoch != 0 && epoch < oldest ) oldest = epoch;
+    }
+    pthread_mutex_unlock( &swmr->lock );
+
+    dict_retired_t* entries = (dict_retired_t*) swmr->retired.data;
+    size_t count = swmr->retired.size / sizeof (dict_retired_t);
+    size_t kept  = 0;
+    for ( size_t i = 0; i < count; i++ )
+    {
+        dict_retired_t* entry = &entries[i];
+        if ( entry->epoch >= oldest )
+        {
+            entries[ kept++ ] = *entry;
+        }
+        else if ( entry->size != 0 )
+        {
+            dict_free_mem( dict, entry->ptr, entry->size );
+        }
+        else
+        {
+            dict_elem_t* elem = entry->ptr;
+            dict_free_key( dict, elem->key );
+            if ( entry->val ) dict_free_val( dict, dict_item_val( dict, elem->key ) );
+            dict_free_node( dict, elem );
+        }
+    }
+    swmr->retired.size = kept * sizeof (dict_retired_t);
+}
+
+
+// hand a node, or a block of `size` bytes, over to the reclamation
+static inline void dict_swmr_retire( dict_t* restrict dict, void* ptr, size_t size, bool val )
+{
+    dict_retired_t entry =
+    {
+        .epoch  = atomic_load_explicit( &dict->swmr.epoch, memory_order_relaxed ),
+        .ptr    = ptr,
+        .size   = size,
+        .val    = val,
+    };
+    if ( dict_buffer_push( dict, &dict->swmr.retired, &entry, sizeof entry ) == false )
+    {
+        fprintf( stderr, "[ERRO]: out of memory.\n" );
+        exit(1);
+    }
+    if ( dict->swmr.retired.size >= dict->swmr.batch * sizeof (dict_retired_t) )
+    {
+        dict_swmr_reclaim( dict );
+    }
+}
+
+
+// free a node that left the buckets, only once no reader can reach it anymore in single writer mode
+static inline void dict_release_elem( dict_t* restrict dict, dict_elem_t* restrict elem, bool val )
+{
+    if ( dict->swmr.enable )
+    {
+        dict_swmr_retire( dict, elem, 0, val );
+        return;
+    }
+    dict_free_key( dict, elem->key );
+    if ( val )
+    {
+        dict_free_val( dict, dict_item_val( dict, elem->key ) );
+    }
+    if ( dict->arena.enable )
+    {
+        dict_arena_free( dict, dict_item_val( dict, elem->key ) );
+    }
+    dict_free_node( dict, elem );
+}
+
+
+static inline uint64_t dict_elem_index( const dict_t* restrict dict, uint64_t code )
+{
+    return code & ( dict->mod - 1 );
+}
+
+
+static inline void dict_link_elem( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_snapshot_touch( dict, dict_elem_index( dict, elem->code ) );
+    dict_list_t* list = &dict->list[ dict_elem_index( dict, elem->code ) ];
+    dict_list_append( list, elem );
+    dict_bin_add( dict, list, elem );
+    dict->len++;
+    if ( dict->dense.enable )
+    {
+        dict_dense_track( dict, elem->key );
+    }
+    if ( dict->cache.enable )
+    {
+        dict_cache_link( dict, elem );
+    }
+    if ( dict->order.enable )
+    {
+        dict_order_add( dict, elem );
+    }
+    if ( dict->ttl.enable )
+    {
+        dict_elem_expiry( dict, elem )->deadline = 0;
+    }
+    if ( dict->filter.enable )
+    {
+        if ( dict->len <= dict->filter.capacity )
+        {
+            dict_filter_add( dict, elem->code );
+        }
+        else if ( dict_filter_rebuild( dict ) == false )
+        {
+            fprintf( stderr, "[ERRO]: out of memory.\n" );
+            exit(1);
+        }
+    }
+}
+
+
+static inline void dict_unlink_elem( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_snapshot_touch( dict, dict_elem_index( dict, elem->code ) );
+    dict_list_t* list = &dict->list[ dict_elem_index( dict, elem->code ) ];
+    dict_delete_node( list, elem );
+    dict_bin_remove( dict, list, elem );
+    dict->len--;
+    if ( dict->cache.enable )
+    {
+        dict_cache_unlink( dict, elem );
+    }
+    if ( dict->order.enable )
+    {
+        dict_order_remove( dict, elem );
+    }
+    if ( dict->ttl.enable )
+    {
+        dict_ttl_unlink( dict, elem );
+    }
+}
+
+
+// unlink and free a node together with its key and val, the val is moved into `out` instead if provided
+static inline void dict_drop_elem( dict_t* restrict dict, dict_elem_t* restrict elem, void* restrict out )
+{
+    if ( dict->log != NULL )
+    {
+        dict_log_record( dict, LOG_DEL, elem->key );
+    }
+    dict_unlink_elem( dict, elem );
+
+    if ( out != NULL )
+    {
+        memcpy( out, dict_item_val( dict, elem->key ), dict->val.size );
+    }
+    dict_release_elem( dict, elem, out == NULL );
+
+    // removed keys stay in the filter until it gets rebuilt
+    if ( dict->filter.enable && ++dict->filter.removed > dict->filter.capacity / 2 )
+    {
+        dict_filter_rebuild( dict );
+    }
+}
+
+
+// free up to `budget` expired pairs, all of them if 0
+static inline size_t dict_ttl_reclaim( dict_t* restrict dict, size_t budget )
+{
+    if ( dict->ttl.count == 0 ) return 0;
+
+    dict_ttl_advance( dict, dict->ttl.now( dict->ttl.ctx ) );
+    if ( dict->ttl.slots[ TTL_DUE ] != NULL )
+    {
+        dict_log_pending( dict );
+    }
+    size_t done = 0;
+    while ( dict->ttl.slots[ TTL_DUE ] != NULL && ( budget == 0 || done < budget ) )
+    {
+        dict_drop_elem( dict, dict->ttl.slots[ TTL_DUE ], NULL );
+        done++;
+    }
+    return done;
+}
+
+
+// an expired node found by a lookup is dropped right away
+static inline bool dict_ttl_expired( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    uint64_t deadline = dict_elem_expiry( dict, elem )->deadline;
+    if ( deadline == 0 || deadline > dict->ttl.now( dict->ttl.ctx ) ) return false;
+    dict_log_pending( dict );
+    dict_drop_elem( dict, elem, NULL );
+    return true;
+}
+
+
+static inline dict_elem_t* dict_find_elem( const dict_t* restrict dict, const void* restrict key, uint64_t code )
+{
+    const dict_list_t* list = &dict->list[ dict_elem_index( dict, code ) ];
+    if ( list->bin != NULL )
+    {
+        // without `key.cmpr` the first candidate is the only one, otherwise every node with the same code is compared
+        for ( size_t i = dict_bin_search( dict, list->bin, list->size, key, code ); i < list->size && list->bin[i]->code == code; i++ )
+        {
+            if ( dict_key_equal( dict, list->bin[i]->key, key ) )
+            {
+                return list->bin[i];
+            }
+            if ( dict->key.cmpr == NULL ) break;
+        }
+        return NULL;
+    }
+
+    for ( dict_elem_t* curr = list->head; curr != NULL; curr = curr->next )
+    {
+        if ( curr->code != code ) continue;
+        if ( dict_key_equal( dict, curr->key, key ) )
+        {
+            return curr;
+        }
+    }
+    return NULL;
+}
+
+
+// look up through the filter first, most misses never touch the buckets
+static inline dict_elem_t* dict_filter_find( dict_t* restrict dict, const void* restrict key, uint64_t code )
+{
+    if ( dict->filter.enable == false )
+    {
+        dict_elem_t* elem = dict_find_elem( dict, key, code );
+        return elem != NULL && dict->ttl.enable && dict_ttl_expired( dict, elem ) ? NULL : elem;
+    }
+
+    dict->filter.queries++;
+    if ( dict_filter_may_have( dict, code ) == false )
+    {
+        dict->filter.negatives++;
+        return NULL;
+    }
+
+    dict_elem_t* elem = dict_find_elem( dict, key, code );
+    if ( elem == NULL )
+    {
+        dict->filter.false_positives++;
+    }
+    return elem != NULL && dict->ttl.enable && dict_ttl_expired( dict, elem ) ? NULL : elem;
+}
+
+
+// move every slot into chained nodes, used once the key range became too sparse
+static inline void dict_dense_to_hash( dict_t* restrict dict )
+{
+    dict->dense.on = false;
+    dict->filter.removed = 0;
+    dict->dense.lo = UINT64_MAX;
+    dict->dense.hi = 0;
+    dict->len      = 0;
+
+    size_t stride = dict->key.size + dict->val.size;
+    for ( size_t i = 0; i < dict->dense.span; i++ )
+    {
+        if ( dict_dense_test( dict, i ) == false ) continue;
+        dict_elem_t* elem = dict_alloc_mem( dict, dict->node_size );
+        ASSERT_MEM( elem );
+        memcpy( elem->key, dict_dense_slot( dict, i ), stride );
+        elem->code = dict_get_hash( dict, elem->key );
+        dict_link_elem( dict, elem );
+
+        // not while a snapshot is running, `dict_snapshot_end` grows the buckets
+        if ( dict_overloaded( dict, dict->len ) && dict->snap == NULL && dict_reshape( dict, 1 ) == false )
+        {
+            fprintf( stderr, "[ERRO]: out of memory.\n" );
+            exit(1);
+        }
+    }
+
+    dict_dense_release( dict );
+
+    // drop the bits left from before the keys became dense
+    if ( dict->filter.enable && dict_filter_rebuild( dict ) == false )
+    {
+        fprintf( stderr, "[ERRO]: out of memory.\n" );
+        exit(1);
+    }
+}
+
+
+// move every node into the slot array, used once the hashed key range became dense
+static inline bool dict_hash_to_dense( dict_t* restrict dict )
+{
+    if ( dict_dense_cover( dict, dict->dense.lo, dict->dense.hi ) == false ) return false;
+
+    size_t stride = dict->key.size + dict->val.size;
+    for ( size_t i = 0; i < dict->mod; i++ )
+    {
+        dict_elem_t* curr = dict->list[i].head;
+        dict_elem_t* next;
+        while ( curr != NULL )
+        {
+            next = curr->next;
+            uint64_t slot = dict_dense_pos( dict, curr->key ) - dict->dense.base;
+            memcpy( dict_dense_slot( dict, slot ), curr->key, stride );
+            dict->dense.bits[ slot / 64 ] |= 1LLU << ( slot % 64 );
+            dict_free_node( dict, curr );
+            curr = next;
+        }
+        dict_bin_free( dict, &dict->list[i] );
+    }
+
+    // back to the inline bucket until the keys get sparse again
+    if ( dict->list != &dict->small )
+    {
+        dict_free_mem( dict, dict->list, sizeof (dict_list_t) * dict->mod );
+    }
+    memset( &dict->small, 0, sizeof (dict_list_t) );
+    dict->list = &dict->small;
+    dict->mod  = 1;
+    dict->dense.on = true;
+    return true;
+}
+
+
+// evict pairs with CLOCK until a new pair of `cost` bytes fits into the limits
+static inline void dict_cache_reserve( dict_t* restrict dict, size_t cost )
+{
+    while ( dict->cache.hand != NULL &&
+          ( ( dict->cache.max_len != 0 && dict->len >= dict->cache.max_len ) ||
+            ( dict->cache.max_bytes != 0 && dict->cache.bytes + cost > dict->cache.max_bytes ) ) )
+    {
+        dict_elem_t*  victim = dict->cache.hand;
+        dict_clock_t* clock  = dict_elem_clock( dict, victim );
+        if ( clock->ref )
+        {
+            clock->ref = false;
+            dict->cache.hand = clock->next;
+            continue;
+        }
+
+        if ( dict->cache.evict != NULL )
+        {
+            dict->cache.evict( victim->key, dict_item_val( dict, victim->key ), dict->cache.ctx );
+        }
+        dict_drop_elem( dict, victim, NULL );
+    }
+}
+
+
+// link a filled node and grow the buckets past the load factor, return the address of its val
+static inline void* dict_place_elem( dict_t* restrict dict, dict_elem_t* restrict elem )
+{
+    dict_link_elem( dict, elem );
+
+    // buckets are not reshaped while a snapshot is walking them
+    if ( dict_overloaded( dict, dict->len ) && dict->snap == NULL )
+    {
+        if ( dict->dense.enable && dict_dense_fits( dict, dict->len, dict->dense.hi - dict->dense.lo ) )
+        {
+            uint64_t pos = dict_dense_pos( dict, elem->key );
+            if ( dict_hash_to_dense( dict ) == false ) return NULL;
+            return dict_dense_slot( dict, pos - dict->dense.base ) + dict->key.size;
+        }
+        if ( dict_reshape( dict, 1 ) == false )
+        {
+            return NULL;
+        }
+    }
+    return dict_item_val( dict, elem->key );
+}
+
+
+// new pair with a copy of `val`, or a zeroed val if NULL
+static inline void* dict_insert_elem( dict_t* restrict dict, const void* restrict key, uint64_t code, const void* restrict val )
+{
+    if ( dict->ttl.enable )
+    {
+        dict_ttl_reclaim( dict, dict->ttl.budget );
+    }
+    if ( dict->cache.enable )
+    {
+        dict_cache_reserve( dict, dict_cache_cost( dict, key ) );
+    }
+
+    dict_elem_t* elem = dict_alloc_mem( dict, dict->node_size );
+    ASSERT_MEM( elem );
+    elem->code = code;
+    dict_copy_key( dict, elem->key, key, code );
+    char* data = dict->arena.enable ? dict_arena_alloc( dict, elem->key ) : elem->key + dict->key.size;
+    memset( data, 0, dict->val.size );
+    if ( val != NULL )
+    {
+        memcpy( data, val, dict->val_data );
+    }
+    return dict_place_elem( dict, elem );
+}
+
+
+// put `elem` in the place of `old`, which holds the same key. Readers find either one or the other
+static inline void dict_swap_elem( dict_t* restrict dict, dict_elem_t* restrict old, dict_elem_t* restrict elem )
+{
+    size_t index = dict_elem_index( dict, old->code );
+    dict_snapshot_touch( dict, index );
+    dict_list_t* list = &dict->list[ index ];
+
+    elem->prev = old->prev;
+    elem->next = old->next;
+    if ( old->next != NULL )
+    {
+        old->next->prev = elem;
+    }
+    else
+    {
+        list->tail = elem;
+    }
+    if ( old->prev != NULL )
+    {
+        dict_store( &old->prev->next, elem );
+    }
+    else
+    {
+        dict_store( &list->head, elem );
+    }
+    for ( size_t i = 0; list->bin != NULL && i < list->size; i++ )
+    {
+        if ( list->bin[i] == old )
+        {
+            list->bin[i] = elem;
+            break;
+        }
+    }
+
+    if ( dict->cache.enable )
+    {
+        dict_cache_unlink( dict, old );
+        dict_cache_link( dict, elem );
+    }
+    if ( dict->order.enable )
+    {
+        dict_order_remove( dict, old );
+        dict_order_add( dict, elem );
+    }
+}
+
+
+static inline void* dict_dense_get( dict_t* restrict dict, const void* restrict key, bool* restrict inserted )
+{
+    uint64_t pos  = dict_dense_pos( dict, key );
+    uint64_t slot = pos - dict->dense.base;
+    if ( slot >= dict->dense.span )
+    {
+        uint64_t lo = pos;
+        uint64_t hi = pos;
+        if ( dict->len != 0 )
+        {
+            uint64_t last = dict->dense.base + dict->dense.span - 1;
+            lo = pos < dict->dense.base ? pos : dict->dense.base;
+            hi = pos > last ? pos : last;
+        }
+        if ( dict_dense_fits( dict, dict->len + 1, hi - lo ) == false )
+        {
+            dict_dense_to_hash( dict );
+            *inserted = true;
+            return dict_insert_elem( dict, key, dict_get_hash( dict, key ), NULL );
+        }
+
+        // grow geometrically toward the new key
+        size_t span = dict->dense.span * DEFAULT_STEP;
+        if ( dict->len == 0 )
+        {
+            dict_dense_release( dict );
+        }
+        else if ( hi - lo + 1 < span )
+        {
+            if ( pos < dict->dense.base )
+            {
+                lo = hi - ( span - 1 ) > hi ? 0 : hi - ( span - 1 );
+            }
+            else
+            {
+                hi = lo + ( span - 1 ) < lo ? UINT64_MAX : lo + ( span - 1 );
+            }
+        }
+        if ( dict_dense_cover( dict, lo, hi ) == false ) return NULL;
+        slot = pos - dict->dense.base;
+    }
+
+    char* item = dict_dense_slot( dict, slot );
+    if ( dict_dense_test( dict, slot ) == false )
+    {
+        dict->dense.bits[ slot / 64 ] |= 1LLU << ( slot % 64 );
+        memcpy( item, key, dict->key.size );
+        memset( dict_item_val( dict, item ), 0, dict->val.size );
+        dict->len++;
+        *inserted = true;
+    }
+    return dict_item_val( dict, item );
+}
+
+
+static inline bool dict_dense_remove( dict_t* restrict dict, const void* restrict key, void* restrict out )
+{
+    uint64_t slot = dict_dense_pos( dict, key ) - dict->dense.base;
+    if ( slot >= dict->dense.span || dict_dense_test( dict, slot ) == false )
+    {
+        return false;
+    }
+
+    if ( dict->log != NULL )
+    {
+        dict_log_record( dict, LOG_DEL, dict_dense_slot( dict, slot ) );
+    }
+    dict->dense.bits[ slot / 64 ] &= ~( 1LLU << ( slot % 64 ) );
+    if ( out != NULL )
+    {
+        memcpy( out, dict_dense_slot( dict, slot ) + dict->key.size, dict->val.size );
+    }
+    else
+    {
+        dict_free_val( dict, dict_dense_slot( dict, slot ) + dict->key.size );
+    }
+    dict->len--;
+
+    if ( dict->len == 0 )
+    {
+        dict_dense_release( dict );
+    }
+    else if ( dict_dense_fits( dict, dict->len * 2, dict->dense.span - 1 ) == false )
+    {
+        dict_dense_to_hash( dict );
+    }
+    return true;
+}
+
+
+// return the address of the val, or NULL if the key is not in the dict. `write` if the val may be modified through the address
+// lookup with the hash code already computed, `code` is ignored while direct-indexed
+static inline void* dict_find_code( dict_t* restrict dict, const void* restrict key, uint64_t code, bool write )
+{
+    if ( write )
+    {
+        dict_log_pending( dict );
+    }
+
+    // direct indexing, no hash involved
+    if ( dict->dense.on )
+    {
+        uint64_t slot = dict_dense_pos( dict, key ) - dict->dense.base;
+        if ( slot < dict->dense.span && dict_dense_test( dict, slot ) )
+        {
+            if ( write )
+            {
+                dict_log_hand( dict, dict_dense_slot( dict, slot ) + dict->key.size, false );
+            }
+            return dict_dense_slot( dict, slot ) + dict->key.size;
+        }
+        return NULL;
+    }
+
+    dict_elem_t* elem = dict_filter_find( dict, key, code );
+    if ( elem == NULL )
+    {
+        return NULL;
+    }
+    if ( write )
+    {
+        dict_snapshot_touch( dict, dict_elem_index( dict, elem->code ) );
+        dict_log_hand( dict, dict_item_val( dict, elem->key ), false );
+    }
+    dict_cache_touch( dict, elem );
+    return dict_item_val( dict, elem->key );
+}
+
+
+static inline void* dict_find_key( dict_t* restrict dict, const void* restrict key, bool write )
+{
+    return dict_find_code( dict, key, dict->dense.on ? 0 : dict_get_hash( dict, key ), write );
+}
+
+
+// lookup of the const queries, an expired pair is skipped but left to the other calls to reclaim, and no counter is updated
+static inline bool dict_has_code( const dict_t* restrict dict, const void* restrict key, uint64_t code )
+{
+    if ( dict->dense.on )
+    {
+        uint64_t slot = dict_dense_pos( dict, key ) - dict->dense.base;
+        return slot < dict->dense.span && dict_dense_test( dict, slot );
+    }
+    if ( dict->filter.enable && dict_filter_may_have( dict, code ) == false )
+    {
+        return false;
+    }
+
+    dict_elem_t* elem = dict_find_elem( dict, key, code );
+    if ( elem == NULL ) return false;
+    if ( dict->ttl.enable == false ) return true;
+    uint64_t deadline = dict_elem_expiry( dict, elem )->deadline;
+    return deadline == 0 || deadline > dict->ttl.now( dict->ttl.ctx );
+}
+
+
+// same as `dict_upsert_key` for a hashed dict, with the hash code of the key already known
+static inline void* dict_upsert_code( dict_t* restrict dict, const void* restrict key, uint64_t code, bool* restrict inserted )
+{
+    *inserted = false;
+    dict_log_pending( dict );
+
+    void* val;
+    dict_elem_t* elem = dict_filter_find( dict, key, code );
+    if ( elem != NULL )
+    {
+        dict_snapshot_touch( dict, dict_elem_index( dict, code ) );
+        dict_cache_touch( dict, elem );
+        dict_log_hand( dict, dict_item_val( dict, elem->key ), false );
+        return dict_item_val( dict, elem->key );
+    }
+
+    // doesn't already appear in the list
+    *inserted = true;
+    val = dict_insert_elem( dict, key, code, NULL );
+    dict_log_hand( dict, val, true );
+    return val;
+}
+
+
+// return the address of the val, insert a zeroed val if the key is not in the dict
+static inline void* dict_upsert_key( dict_t* restrict dict, const void* restrict key, bool* restrict inserted )
+{
+    bool ignore;
+    if ( inserted == NULL )
+    {
+        inserted = &ignore;
+    }
+    *inserted = false;
+    dict_log_pending( dict );
+
+    if ( dict->dense.on )
+    {
+        void* val = dict_dense_get( dict, key, inserted );
+        dict_log_hand( dict, val, *inserted );
+        return val;
+    }
+
+    return dict_upsert_code( dict, key, dict_get_hash( dict, key ), inserted );
+}
+
+
+// store a copy of `val` for `key`. In single writer mode the pair is published complete, and an existing one is replaced by a new node
+static inline bool dict_set_key( dict_t* restrict dict, const void* restrict key, const void* restrict val )
+{
+    bool inserted;
+    if ( dict->swmr.enable == false )
+    {
+        void* dest = dict_upsert_key( dict, key, &inserted );
+        ASSERT_MEM( dest );
+        if ( inserted == false )
+        {
+            dict_free_val( dict, dest );
+        }
+        memcpy( dest, val, dict->val_data );
+        return inserted;
+    }
+
+    dict_log_pending( dict );
+    uint64_t code = dict_get_hash( dict, key );
+    dict_elem_t* old = dict_filter_find( dict, key, code );
+    char* item;
+    if ( old == NULL )
+    {
+        item = dict_insert_elem( dict, key, code, val );
+        ASSERT_MEM( item );
+        item -= dict->key.size;
+    }
+    else
+    {
+        dict_elem_t* elem = dict_alloc_mem( dict, dict->node_size );
+        ASSERT_MEM( elem );
+        elem->code = code;
+        dict_copy_key( dict, elem->key, key, code );
+        memset( dict_item_val( dict, elem->key ), 0, dict->val.size );
+        memcpy( dict_item_val( dict, elem->key ), val, dict->val_data );
+        dict_swap_elem( dict, old, elem );
+        dict_release_elem( dict, old, true );
+        item = elem->key;
+    }
+    if ( dict->log != NULL )
+    {
+        dict_log_record( dict, LOG_PUT, item );
+    }
+    return old == NULL;
+}
+
+
+// remove the key, the val is moved into `out` instead of being freed if provided
+// removal with the hash code already computed, `code` is ignored while direct-indexed
+static inline bool dict_take_code( dict_t* restrict dict, const void* restrict key, uint64_t code, void* restrict out )
+{
+    dict_log_pending( dict );
+
+    if ( dict->dense.on )
+    {
+        return dict_dense_remove( dict, key, out );
+    }
+
+    dict_elem_t* elem = dict_filter_find( dict, key, code );
+    if ( elem == NULL )
+    {
+        return false;
+    }
+
+    // redirect node, delete key and val and node
+    dict_drop_elem( dict, elem, out );
+    return true;
+}
+
+
+static inline bool dict_take_key( dict_t* restrict dict, const void* restrict key, void* restrict out )
+{
+    return dict_take_code( dict, key, dict->dense.on ? 0 : dict_get_hash( dict, key ), out );
+}
+
+
+// iterate over every pair, return the address of the key followed by its val, or NULL at the end
+static inline char* dict_next( const dict_t* restrict dict, dict_cursor_t* restrict cursor )
+{
+    if ( dict->dense.on )
+    {
+        for ( ; cursor->index < dict->dense.span; cursor->index++ )
+        {
+            if ( dict_dense_test( dict, cursor->index ) )
+            {
+                return dict_dense_slot( dict, cursor->index++ );
+            }
+        }
+        return NULL;
+    }
+
+    if ( cursor->elem != NULL && cursor->elem->next != NULL )
+    {
+        cursor->elem = cursor->elem->next;
+        return cursor->elem->key;
+    }
+    for ( ; cursor->index < dict->mod; cursor->index++ )
+    {
+        if ( dict->list[ cursor->index ].head != NULL )
+        {
+            cursor->elem = dict->list[ cursor->index++ ].head;
+            return cursor->elem->key;
+        }
+    }
+    return NULL;
+}
+
+
+static inline size_t dict_key_size( dict_key_attr_t key )
+{
+    switch ( key.type )
+    {
+        case DICT_CHAR:    return sizeof ( char );
+        case DICT_WCHAR:   return sizeof ( wchar_t );
+        case DICT_I32:     return sizeof ( int32_t );
+        case DICT_U32:     return sizeof ( uint32_t );
+        case DICT_F32:     return sizeof ( float );
+        case DICT_I64:     return sizeof ( int64_t );
+        case DICT_U64:     return sizeof ( uint64_t );
+        case DICT_F64:     return sizeof ( double );
+        case DICT_PTR:     return sizeof ( void* );
+        case DICT_STR:     return sizeof ( char* );
+        case DICT_STRUCT:  return ( key.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
+        default:           fprintf( stderr, "[ERRO]: illegal type.\n" );    exit(1);
+    }
+}
+
+
+static inline size_t dict_val_size( dict_val_attr_t val )
+{
+    return ( val.size + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
+}
+
+
+// the dict and the key read from the arguments share one allocation
+static inline size_t dict_self_size( size_t key_size )
+{
+    return ( ( sizeof (dict_t) + alignof (max_align_t) - 1 ) & ~( alignof (max_align_t) - 1 ) ) + key_size;
+}
+
+
+static dict_t* dict_init( dict_args_t args )
+{
+    dict_alloc_t alloc = dict_alloc_init( args.alloc, &args.alloc );
+    dict_t* dict = alloc.alloc( alloc.ctx, dict_self_size( dict_key_size( args.key ) ), alignof (dict_t) );
+    ASSERT_MEM( dict );
+    dict->alloc = dict_alloc_init( args.alloc, &dict->alloc );
+
+    dict->key = args.key;
+    dict->key.size = dict_key_size( args.key );
+    if ( args.key.type != DICT_STR || args.key.copy != NULL || args.key.hash != NULL )
+    {
+        dict->key.pool = NULL;
+    }
+
+    dict->val = args.val;
+    dict->val.size = dict_val_size( args.val );
+    dict->val_data = args.val.size;
+
+    dict->key_temp = (char*) dict + dict_self_size( 0 );
+    memset( dict->key_temp, 0, dict->key.size );
+    dict->key_data = args.key.type == DICT_STRUCT ? args.key.size : dict->key.size;
+
+    // split storage leaves a pointer to the val in the node
+    dict->arena = (dict_arena_t) { .enable = args.val.split && dict->val.size != 0, .slot = sizeof (char*) + dict->val.size, .count = ARENA_MIN };
+
+    // data used by the optional features is placed after the val of each node
+    size_t ext = ( dict->key.size + ( dict->arena.enable ? sizeof (char*) : dict->val.size ) + ( sizeof (uintptr_t) - 1 ) ) & ~( sizeof (uintptr_t) - 1 );
+
+    dict->cache = (dict_cache_t)
+    {
+        .enable     = args.cache.max_len != 0 || args.cache.max_bytes != 0,
+        .offset     = ext,
+        .max_len    = args.cache.max_len,
+        .max_bytes  = args.cache.max_bytes,
+        .evict      = args.cache.evict,
+        .ctx        = args.cache.ctx,
+    };
+    if ( dict->cache.enable )
+    {
+        ext += sizeof (dict_clock_t);
+    }
+
+    dict->order = (dict_order_t) { .enable = args.order.enable, .cmpr = args.order.cmpr, .offset = ext };
+    if ( dict->order.enable )
+    {
+        ext += sizeof (size_t);
+        dict->order.bound = dict_alloc_mem( dict, dict->key.size );
+        ASSERT_MEM( dict->order.bound );
+        memset( dict->order.bound, 0, dict->key.size );
+    }
+    dict->ttl = (dict_ttl_t) { .enable = args.ttl.enable, .offset = ext };
+    if ( dict->ttl.enable )
+    {
+        ext += sizeof (dict_expiry_t);
+        dict->ttl.now    = args.ttl.now != NULL ? args.ttl.now : dict_ttl_clock;
+        dict->ttl.ctx    = args.ttl.ctx;
+        dict->ttl.budget = args.ttl.budget != 0 ? args.ttl.budget : TTL_BUDGET;
+        dict->ttl.tick   = dict->ttl.now( dict->ttl.ctx );
+        dict->ttl.slots  = dict_alloc_mem( dict, sizeof (dict_elem_t*) * ( TTL_FAR + 1 ) );
+        ASSERT_MEM( dict->ttl.slots );
+        memset( dict->ttl.slots, 0, sizeof (dict_elem_t*) * ( TTL_FAR + 1 ) );
+    }
+    dict->node_size = sizeof (dict_elem_t) + ext;
+
+    // a single inline bucket, an empty dict is one allocation
+    dict->len   = 0;
+    dict->mod   = 1;
+    dict->list  = &dict->small;
+    memset( &dict->small, 0, sizeof (dict_list_t) );
+
+    // direct indexing is only possible for built-in integer keys
+    dict->dense = (dict_dense_t) { .lo = UINT64_MAX };
+    if ( args.dense.enable && dict->cache.enable == false && args.order.enable == false && ( args.swmr.enable == false || args.agg.enable ) && args.ttl.enable == false && dict->arena.enable == false && args.key.copy == NULL && args.key.hash == NULL && args.key.cmpr == NULL )
+    {
+        switch ( args.key.type )
+        {
+            case DICT_CHAR:
+            case DICT_WCHAR:
+            case DICT_I32:
+            case DICT_U32:
+            case DICT_I64:
+            case DICT_U64:
+            {
+                dict->dense.enable  = true;
+                dict->dense.on      = true;
+                dict->dense.fill    = args.dense.fill > 0 ? args.dense.fill : DEFAULT_FILL;
+                break;
+            }
+            default: break;
+        }
+    }
+
+    dict->snap   = NULL;
+    dict->log    = NULL;
+    memset( &dict->swmr, 0, sizeof (dict_swmr_t) );
+    dict->swmr.enable = args.swmr.enable && args.agg.enable == false && args.ttl.enable == false && dict->arena.enable == false;
+    dict->swmr.batch  = args.swmr.batch != 0 ? args.swmr.batch : SWMR_BATCH;
+    atomic_init( &dict->swmr.epoch, 1 );
+    atomic_init( &dict->swmr.seq, 0 );
+    if ( dict->swmr.enable )
+    {
+        pthread_mutex_init( &dict->swmr.lock, NULL );
+    }
+    dict->agg = (dict_agg_t) { .enable = args.agg.enable, .op = args.agg.op, .type = args.agg.type, .combine = args.agg.combine, .ctx = args.agg.ctx };
+    if ( dict->agg.enable )
+    {
+        // the built-in ops need a numeric val of the size of the type
+        bool numeric = dict->agg.type <= DICT_F64 && dict->agg.type >= DICT_I32 && dict_key_size( (dict_key_attr_t) { .type = dict->agg.type } ) == args.val.size;
+        if ( dict->agg.op == DICT_AGG_CALL ? dict->agg.combine == NULL : numeric == false )
+        {
+            fprintf( stderr, "[ERRO]: aggregation does not match the val.\n" );
+            exit(1);
+        }
+        pthread_mutex_init( &dict->agg.lock, NULL );
+    }
+    dict->filter = (dict_filter_t) { .enable = args.filter.enable };
+    if ( dict->filter.enable )
+    {
+        dict->filter.bits = args.filter.bits != 0 ? args.filter.bits : FILTER_BITS;
+        dict_filter_rebuild( dict );
+        ASSERT_MEM( dict->filter.data );
+    }
+#ifdef DICT_PROFILE
+    dict->prof = NULL;
+#endif  // DICT_PROFILE
+
+    return dict;
+}
+
+
+dict_t* dict_create( dict_args_t args )
+{
+    return dict_init( args );
+}
+
+
+dict_t* dict_new( dict_type_t key_type, size_t key_size, size_t val_size )
+{
+    return dict_create( (dict_args_t)
+    {
+        .key = (dict_key_attr_t)
+        {
+            .type = key_type,
+            .size = key_size,
+        },
+        .val = (dict_val_attr_t)
+        {
+            .size = val_size,
+        },
+        .alloc = (dict_alloc_t) { 0 },
+    });
+}
+
+
+void dict_destroy( dict_t* restrict dict )
+{
+    assert( dict->snap == NULL );
+    dict_log_close( dict );
+
+    for ( size_t i = 0; i < dict->mod; i++ )
+    {
+        dict_elem_t* curr = dict->list[i].head;
+        dict_elem_t* next;
+        while ( curr != NULL )
+        {
+            next = curr->next;
+
+            dict_free_key( dict, curr->key );
+            if ( dict->val.size != 0 )
+            {
+                dict_free_val( dict, dict_item_val( dict, curr->key ) );
+            }
+            dict_free_node( dict, curr );
+
+            curr = next;
+        }
+        dict_bin_free( dict, &dict->list[i] );
+    }
+
+    if ( dict->dense.on && dict->val.size != 0 )
+    {
+        dict_cursor_t cursor = { 0 };
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            dict_free_val( dict, dict_item_val( dict, item ) );
+        }
+    }
+    dict_dense_release( dict );
+
+    if ( dict->filter.raw != NULL )
+    {
+        dict_free_mem( dict, dict->filter.raw, dict_filter_bytes( dict->filter.blocks ) );
+    }
+    if ( dict->order.enable )
+    {
+        if ( dict->order.items != NULL )        dict_free_mem( dict, dict->order.items, sizeof (dict_elem_t*) * ( dict->order.len + 1 ) );
+        if ( dict->order.pending.data != NULL ) dict_free_mem( dict, dict->order.pending.data, dict->order.pending.cap );
+        dict_free_mem( dict, dict->order.bound, dict->key.size );
+    }
+    if ( dict->swmr.enable )
+    {
+        // every reader has left, so everything retired can go
+        assert( dict->swmr.readers == NULL );
+        dict_swmr_reclaim( dict );
+        if ( dict->swmr.retired.data != NULL ) dict_free_mem( dict, dict->swmr.retired.data, dict->swmr.retired.cap );
+        pthread_mutex_destroy( &dict->swmr.lock );
+    }
+    if ( dict->agg.enable )
+    {
+        dict_t** tables = (dict_t**) dict->agg.pending.data;
+        for ( size_t i = 0; i < dict->agg.pending.size / sizeof (dict_t*); i++ )
+        {
+            dict_destroy( tables[i] );
+        }
+        if ( tables != NULL ) dict_free_mem( dict, tables, dict->agg.pending.cap );
+        pthread_mutex_destroy( &dict->agg.lock );
+    }
+    if ( dict->ttl.enable )
+    {
+        dict_free_mem( dict, dict->ttl.slots, sizeof (dict_elem_t*) * ( TTL_FAR + 1 ) );
+    }
+    dict_arena_release( dict );
+    dict_profile_stop( dict );
+    if ( dict->list != &dict->small )
+    {
+        dict_free_mem( dict, dict->list, sizeof (dict_list_t) * dict->mod );
+    }
+    dict_free_mem( dict, dict, dict_self_size( dict->key.size ) );
+}
+
+
+void* dict_get( dict_t* restrict dict, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, dict );
+
+    // get the key
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    void* result = dict_upsert_key( dict, key, NULL );
+    PROF_END( dict, DICT_PROF_GET );
+    return result;
+}
+
+
+void* dict_find( dict_t* restrict dict, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, dict );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    void* result = dict_find_key( dict, key, true );
+    PROF_END( dict, DICT_PROF_FIND );
+    return result;
+}
+
+
+void* dict_upsert( dict_t* restrict dict, bool* restrict inserted, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, inserted );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    void* result = dict_upsert_key( dict, key, inserted );
+    PROF_END( dict, DICT_PROF_GET );
+    return result;
+}
+
+
+void* dict_get_or_init( dict_t* restrict dict, dict_val_init init, void* ctx, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, ctx );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool inserted;
+    void* val = dict_upsert_key( dict, key, &inserted );
+    if ( inserted && val != NULL && init != NULL )
+    {
+        init( key, val, ctx );
+    }
+    PROF_END( dict, DICT_PROF_GET );
+    return val;
+}
+
+
+bool dict_take( dict_t* restrict dict, void* restrict val, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, val );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool result = dict_take_key( dict, key, val );
+    PROF_END( dict, DICT_PROF_REMOVE );
+    return result;
+}
+
+
+bool dict_remove( dict_t* restrict dict, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, dict );
+
+    // get the key
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool result = dict_take_key( dict, key, NULL );
+    PROF_END( dict, DICT_PROF_REMOVE );
+    return result;
+}
+
+
+bool dict_has( const dict_t* restrict dict, ... )
+{
+    va_list ap;
+    va_start( ap, dict );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    return dict_has_code( dict, key, dict->dense.on ? 0 : dict_get_hash( dict, key ) );
+}
+
+
+uint64_t dict_hash_key( const dict_t* restrict dict, ... )
+{
+    va_list ap;
+    va_start( ap, dict );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    return dict_get_hash( dict, key );
+}
+
+
+void* dict_get_prehashed( dict_t* restrict dict, uint64_t code, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, code );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool inserted;
+    void* result = dict->dense.on ? dict_upsert_key( dict, key, NULL ) : dict_upsert_code( dict, key, code, &inserted );
+    PROF_END( dict, DICT_PROF_GET );
+    return result;
+}
+
+
+void* dict_find_prehashed( dict_t* restrict dict, uint64_t code, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, code );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    void* result = dict_find_code( dict, key, code, true );
+    PROF_END( dict, DICT_PROF_FIND );
+    return result;
+}
+
+
+bool dict_has_prehashed( const dict_t* restrict dict, uint64_t code, ... )
+{
+    va_list ap;
+    va_start( ap, code );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    return dict_has_code( dict, key, code );
+}
+
+
+bool dict_remove_prehashed( dict_t* restrict dict, uint64_t code, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, code );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool result = dict_take_code( dict, key, code, NULL );
+    PROF_END( dict, DICT_PROF_REMOVE );
+    return result;
+}
+
+
+bool dict_set( dict_t* restrict dict, const void* restrict val, ... )
+{
+    PROF_BEGIN( dict );
+
+    va_list ap;
+    va_start( ap, val );
+
+    void* key = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    bool result = dict_set_key( dict, key, val );
+    PROF_END( dict, DICT_PROF_GET );
+    return result;
+}
+
+
+size_t dict_len( const dict_t* restrict dict )
+{
+    return dict->len;
+}
+
+
+const void* dict_key( const dict_t* restrict dict, size_t* restrict size )
+{
+    *size = dict_len( dict );
+
+    if ( *size == 0 )
+    {
+        return NULL;
+    }
+
+    char* arr = dict_alloc_mem( dict, dict->key.size * (*size) );
+
+    size_t index = 0;
+    dict_cursor_t cursor = { 0 };
+    for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+    {
+        memcpy( arr + ( dict->key.size * index ), item, dict->key.size );
+        if ( ++index == *size ) return arr;
+    }
+
+    return arr;
+}
+
+
+static void* dict_encode( const dict_t* restrict dict, size_t* restrict bytes )
+{
+    size_t space;
+    if ( bytes == NULL )
+    {
+        bytes = &space;
+    }
+
+    // calculate key size and val size
+    uint32_t size = dict_len( dict );
+    uint32_t key_val_size[3] = { dict->key.size, dict->val.size | ( dict->arena.enable ? SERIAL_SPLIT : 0 ), size };
+    size_t   head_size = dict->key.type == DICT_STR ? sizeof (uint32_t) : dict->key.size;
+    size_t   elem_size = head_size + dict->val.size;
+
+    // calculate total size
+    *bytes = sizeof (uint32_t) * 3 + size * elem_size;
+
+    // calculate key size if string type
+    #ifdef __STDC_NO_VLA__
+        uint32_t* strlen_table;
+        if (dict->key.type == DICT_STR )
+        {
+            strlen_table = dict_alloc_mem( dict, sizeof (uint32_t) * size );
+            ASSERT_MEM( strlen_table );
+        }
+    #else
+        uint32_t strlen_table[size];
+    #endif  // __STDC_NO_VLA__
+    dict_cursor_t cursor;
+    if ( dict->key.type == DICT_STR )
+    {
+        size_t index = 0;
+        cursor = (dict_cursor_t) { 0 };
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            strlen_table[index] = (uint32_t) dict_key_length( dict, *(char**) item );
+            *bytes += strlen_table[index];
+            index++;
+        }
+    }
+
+
+    // allocate memory
+    void* data = dict_alloc_mem( dict, *bytes );
+    if ( data == NULL )
+    {
+        *bytes = 0;
+        return NULL;
+    }
+    char* ptr = data;
+
+    // store header
+    memcpy( ptr, key_val_size, sizeof (uint32_t) * 3 );
+    ptr += sizeof (uint32_t) * 3;
+
+    // store individual items, split storage writes every key first and then the vals as one block
+    cursor = (dict_cursor_t) { 0 };
+    char* vals = dict->arena.enable ? ptr + size * head_size : NULL;
+    if ( dict->key.type == DICT_STR )
+    {
+        size_t index = 0;
+        char* str_ptr = ptr + size * elem_size;
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            memcpy( ptr, &strlen_table[index], sizeof (uint32_t) );
+            ptr += sizeof (uint32_t);
+            if ( vals != NULL )
+            {
+                memcpy( vals, dict_item_val( dict, item ), dict->val.size );
+                vals += dict->val.size;
+            }
+            else
+            {
+                memcpy( ptr, dict_item_val( dict, item ), dict->val.size );
+                ptr += dict->val.size;
+            }
+            memcpy( str_ptr, *(char**) item, strlen_table[index] );
+            str_ptr += strlen_table[index];
+            index++;
+        }
+    }
+    else
+    {
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            if ( vals != NULL )
+            {
+                memcpy( ptr, item, dict->key.size );
+                memcpy( vals, dict_item_val( dict, item ), dict->val.size );
+                ptr  += dict->key.size;
+                vals += dict->val.size;
+            }
+            else
+            {
+                memcpy( ptr, item, elem_size );
+                ptr += elem_size;
+            }
+        }
+    }
+
+    // clean up memory allocation
+    #ifdef __STDC_NO_VLA__
+        if ( dict->key.type == DICT_STR )
+        {
+            dict_free_mem( dict, strlen_table, sizeof (uint32_t) * size );
+        }
+    #endif  // __STDC_NO_VLA__
+
+    return data;
+}
+
+
+void* dict_serialize( const dict_t* restrict dict, size_t* restrict bytes )
+{
+#ifdef DICT_PROFILE
+    if ( dict->prof != NULL )
+    {
+        uint64_t start = dict_prof_clock();
+        void*    data  = dict_encode( dict, bytes );
+        dict_prof_end( dict, DICT_PROF_SERIALIZE, start );
+        return data;
+    }
+#endif  // DICT_PROFILE
+    return dict_encode( dict, bytes );
+}
+
+
+dict_t* dict_deserialize( dict_args_t args, const void* restrict data )
+{
+    const char* ptr = data;
+    uint32_t key_val_size[3];
+    memcpy( key_val_size, ptr, sizeof (uint32_t) * 3 );
+    ptr += sizeof (uint32_t) * 3;
+
+    if ( dict_key_size( args.key ) != key_val_size[0] )
+    {
+        fprintf( stderr, "[ERRO]: key type conflict, data corrupted.\n" );
+        return NULL;
+    }
+
+    bool split = ( key_val_size[1] & SERIAL_SPLIT ) != 0;
+    if ( dict_val_size( args.val ) != ( key_val_size[1] & ~SERIAL_SPLIT ) )
+    {
+        fprintf( stderr, "[ERRO]: val type conflict, data corrupted.\n" );
+        return NULL;
+    }
+
+    dict_t* dict = dict_init( args );
+
+    // assign all the values
+    size_t      head_size = dict->key.type == DICT_STR ? sizeof (uint32_t) : dict->key.size;
+    size_t      elem_size = head_size + dict->val.size;
+    const char* vals      = split ? ptr + key_val_size[2] * head_size : NULL;
+    void* val;
+    if ( dict->key.type == DICT_STR )
+    {
+        const char* str_ptr = ptr + key_val_size[2] * elem_size;
+        size_t      length  = 0;
+        char*       str     = NULL;
+        for ( size_t i = 0; i < key_val_size[2]; i++ )
+        {
+            // strings are not null terminated in the data
+            uint32_t str_len;
+            memcpy( &str_len, ptr, sizeof (uint32_t) );
+            if ( str_len + 1 > length )
+            {
+                if ( str != NULL ) dict_free_mem( dict, str, length );
+                length = str_len + 1;
+                str = dict_alloc_mem( dict, length );
+                ASSERT_MEM( str );
+            }
+            memcpy( str, str_ptr, str_len );
+            str[ str_len ] = 0;
+            str_ptr += str_len;
+            ptr += sizeof (uint32_t);
+            val = dict_insert_elem( dict, &str, dict_get_hash( dict, &str ), NULL );
+            if ( val == NULL )
+            {
+                dict_free_mem( dict, str, length );
+                dict_destroy( dict );
+                return NULL;
+            }
+            if ( vals != NULL )
+            {
+                memcpy( val, vals, dict->val.size );
+                vals += dict->val.size;
+            }
+            else
+            {
+                memcpy( val, ptr, dict->val.size );
+                ptr += dict->val.size;
+            }
+        }
+        if ( str != NULL ) dict_free_mem( dict, str, length );
+    }
+    else
+    {
+        for ( size_t i = 0; i < key_val_size[2]; i++ )
+        {
+            // records are not aligned after the header
+            memcpy( dict->key_temp, ptr, dict->key.size );
+            val = dict_upsert_key( dict, dict->key_temp, NULL );
+            if ( val == NULL )
+            {
+                dict_destroy( dict );
+                return NULL;
+            }
+            if ( vals != NULL )
+            {
+                memcpy( val, vals, dict->val.size );
+                vals += dict->val.size;
+                ptr  += dict->key.size;
+            }
+            else
+            {
+                memcpy( val, ptr + dict->key.size, dict->val.size );
+                ptr += elem_size;
+            }
+        }
+    }
+
+    return dict;
+}
+
+
+dict_stats_t dict_stats( const dict_t* restrict dict )
+{
+    dict_stats_t stats =
+    {
+        .len                = dict->len,
+        .buckets            = dict->dense.on ? 0 : dict->mod,
+        .dense              = dict->dense.on,
+        .filter_queries     = dict->filter.queries,
+        .filter_negatives   = dict->filter.negatives,
+        .filter_false       = dict->filter.false_positives,
+    };
+
+    for ( size_t i = 0; dict->dense.on == false && i < dict->mod; i++ )
+    {
+        if ( dict->list[i].size > stats.longest )
+        {
+            stats.longest = dict->list[i].size;
+        }
+        if ( dict->list[i].bin != NULL )
+        {
+            stats.bins++;
+        }
+    }
+
+    if ( stats.filter_negatives + stats.filter_false != 0 )
+    {
+        stats.filter_fpr = (double) stats.filter_false / (double) ( stats.filter_negatives + stats.filter_false );
+    }
+
+    return stats;
+}
+
+
+// stored hash codes of `src` are only valid in `dst` if both hash and compare the keys the same way
+static inline bool dict_merge_compatible( const dict_t* restrict dst, const dict_t* restrict src )
+{
+    return dst != src &&
+           dst->key.type == src->key.type && dst->key.size == src->key.size &&
+           dst->key.copy == src->key.copy && dst->key.free == src->key.free &&
+           dst->key.hash == src->key.hash && dst->key.cmpr == src->key.cmpr &&
+           dst->val.size == src->val.size;
+}
+
+
+// resolve a key found in both dicts, a moved `src_val` that was not taken over is freed
+static inline void dict_merge_conflict( dict_t* dst, const dict_t* src, void* dst_val, void* src_val, dict_conflict_t policy, dict_combine combine, void* ctx, bool move )
+{
+    switch ( policy )
+    {
+        case DICT_OVERWRITE:
+            dict_free_val( dst, dst_val );
+            memcpy( dst_val, src_val, dst->val.size );
+            return;
+        case DICT_COMBINE:
+            combine( dst_val, src_val, ctx );
+            break;
+        case DICT_KEEP:
+        default:
+            break;
+    }
+    if ( move )
+    {
+        dict_free_val( src, src_val );
+    }
+}
+
+
+// copy one pair of `src` into `dst`, `elem` is the node of the pair if `src` is hashed
+// `deadline` is the one of the pair in `src`, carried over if the key is new to `dst`
+static inline bool dict_merge_item( dict_t* restrict dst, const dict_t* restrict src, char* item, const dict_elem_t* elem, uint64_t deadline, dict_conflict_t policy, dict_combine combine, void* ctx, bool move )
+{
+    bool  inserted;
+    void* val;
+    if ( dst->dense.on )
+    {
+        val = dict_upsert_key( dst, item, &inserted );
+    }
+    else
+    {
+        val = dict_upsert_code( dst, item, elem != NULL ? elem->code : dict_get_hash( dst, item ), &inserted );
+    }
+    if ( val == NULL ) return false;
+
+    if ( inserted )
+    {
+        memcpy( val, dict_item_val( src, item ), dst->val.size );
+        if ( deadline != 0 && dst->dense.on == false )
+        {
+            dict_ttl_carry( dst, src, (dict_elem_t*) ( dict_val_item( dst, val ) - offsetof( dict_elem_t, key ) ), deadline );
+        }
+    }
+    else
+    {
+        dict_merge_conflict( dst, src, val, dict_item_val( src, item ), policy, combine, ctx, move );
+    }
+    return true;
+}
+
+
+static bool dict_merge_pairs( dict_t* restrict dst, dict_t* restrict src, dict_conflict_t policy, dict_combine combine, void* ctx, bool move )
+{
+    if ( dict_merge_compatible( dst, src ) == false || ( policy == DICT_COMBINE && combine == NULL ) )
+    {
+        return false;
+    }
+    if ( dict_presize( dst, dst->len + src->len ) == false )
+    {
+        return false;
+    }
+    if ( move )
+    {
+        dict_log_pending( src );
+    }
+
+    if ( move == false || src->dense.on )
+    {
+        dict_cursor_t cursor = { 0 };
+        for ( char* item = dict_next( src, &cursor ); item != NULL; item = dict_next( src, &cursor ) )
+        {
+            uint64_t deadline = src->ttl.enable ? dict_elem_expiry( src, cursor.elem )->deadline : 0;
+            if ( dict_merge_item( dst, src, item, src->dense.on ? NULL : cursor.elem, deadline, policy, combine, ctx, move ) == false )
+            {
+                return false;
+            }
+            if ( move && src->log != NULL )
+            {
+                dict_log_record( src, LOG_DEL, item );
+            }
+        }
+        if ( move )
+        {
+            dict_dense_release( src );
+            src->len = 0;
+        }
+        return true;
+    }
+
+    // nodes are handed over as they are when both dicts lay them out and allocate them the same way
+    bool relink = dst->log == NULL && dst->node_size == src->node_size && dst->cache.offset == src->cache.offset &&
+                  dst->cache.enable == src->cache.enable && dst->order.enable == src->order.enable && dst->ttl.enable == src->ttl.enable &&
+                  dst->arena.enable == false && src->arena.enable == false && dst->key.pool == src->key.pool &&
+                  dict_alloc_same( &dst->alloc, &src->alloc );
+    bool done   = true;
+    for ( size_t i = 0; i < src->mod && done; i++ )
+    {
+        while ( src->list[i].head != NULL && done )
+        {
+            dict_elem_t* elem     = src->list[i].head;
+            uint64_t     deadline = src->ttl.enable ? dict_elem_expiry( src, elem )->deadline : 0;
+            if ( src->log != NULL )
+            {
+                dict_log_record( src, LOG_DEL, elem->key );
+            }
+            dict_unlink_elem( src, elem );
+
+            if ( relink && dst->dense.on == false )
+            {
+                dict_elem_t* found = dict_filter_find( dst, elem->key, elem->code );
+                if ( found == NULL )
+                {
+                    if ( dst->cache.enable )
+                    {
+                        dict_cache_reserve( dst, dict_cache_cost( dst, elem->key ) );
+                    }
+                    done = dict_place_elem( dst, elem ) != NULL;
+                    if ( done )
+                    {
+                        dict_ttl_carry( dst, src, elem, deadline );
+                    }
+                    continue;
+                }
+                dict_snapshot_touch( dst, dict_elem_index( dst, found->code ) );
+                dict_cache_touch( dst, found );
+                dict_merge_conflict( dst, src, dict_item_val( dst, found->key ), dict_item_val( src, elem->key ), policy, combine, ctx, true );
+            }
+            else
+            {
+                done = dict_merge_item( dst, src, elem->key, elem, deadline, policy, combine, ctx, true );
+            }
+            dict_release_elem( src, elem, false );
+        }
+    }
+
+    // every key left the filter at once
+    src->dense.lo = UINT64_MAX;
+    src->dense.hi = 0;
+    if ( src->filter.enable && dict_filter_rebuild( src ) == false )
+    {
+        return false;
+    }
+    return done;
+}
+
+
+bool dict_merge( dict_t* restrict dst, const dict_t* restrict src, dict_conflict_t policy, dict_combine combine, void* ctx )
+{
+    return dict_merge_pairs( dst, (dict_t*) src, policy, combine, ctx, false );
+}
+
+
+bool dict_merge_move( dict_t* restrict dst, dict_t* restrict src, dict_conflict_t policy, dict_combine combine, void* ctx )
+{
+    return dict_merge_pairs( dst, src, policy, combine, ctx, true );
+}
+
+
+// fill a batch with the next pairs of `dict`, return false once there is none left
+static inline bool dict_set_fill( const dict_t* restrict dict, dict_cursor_t* restrict cursor, dict_set_batch_t* restrict batch )
+{
+    char* item;
+    batch->len = 0;
+    while ( batch->len < SET_BATCH && ( item = dict_next( dict, cursor ) ) != NULL )
+    {
+        batch->items[ batch->len ] = item;
+        batch->elems[ batch->len ] = dict->dense.on ? NULL : cursor->elem;
+        batch->len++;
+    }
+    return batch->len != 0;
+}
+
+
+// look the keys of a batch up in `dict`. The buckets of the whole batch are prefetched, then their first nodes, before any chain is walked
+static inline void dict_set_probe( const dict_t* restrict dict, dict_set_batch_t* restrict batch )
+{
+    if ( dict->dense.on )
+    {
+        for ( size_t i = 0; i < batch->len; i++ )
+        {
+            uint64_t slot = dict_dense_pos( dict, batch->items[i] ) - dict->dense.base;
+            batch->found[i] = slot < dict->dense.span && dict_dense_test( dict, slot );
+            batch->hits[i]  = NULL;
+        }
+        return;
+    }
+
+    // the codes stored in the nodes are reused, both dicts hash the same way
+    for ( size_t i = 0; i < batch->len; i++ )
+    {
+        batch->codes[i] = batch->elems[i] != NULL ? batch->elems[i]->code : dict_get_hash( dict, batch->items[i] );
+        batch->found[i] = dict->filter.enable == false || dict_filter_may_have( dict, batch->codes[i] );
+        if ( batch->found[i] )
+        {
+            dict_prefetch( &dict->list[ dict_elem_index( dict, batch->codes[i] ) ] );
+        }
+    }
+    for ( size_t i = 0; i < batch->len; i++ )
+    {
+        if ( batch->found[i] )
+        {
+            dict_prefetch( dict->list[ dict_elem_index( dict, batch->codes[i] ) ].head );
+        }
+    }
+    for ( size_t i = 0; i < batch->len; i++ )
+    {
+        batch->hits[i]  = batch->found[i] ? dict_find_elem( dict, batch->items[i], batch->codes[i] ) : NULL;
+        batch->found[i] = batch->hits[i] != NULL;
+    }
+}
+
+
+// remember a pair of `dst` to remove once the lookups are done, its node while hashed and a copy of its key while direct-indexed
+static inline bool dict_set_mark( const dict_t* restrict dst, dict_buffer_t* restrict drop, const char* restrict key, dict_elem_t* elem )
+{
+    if ( dst->dense.on )
+    {
+        return dict_buffer_push( dst, drop, key, dst->key.size );
+    }
+    return dict_buffer_push( dst, drop, &elem, sizeof (dict_elem_t*) );
+}
+
+
+static inline void dict_set_drop( dict_t* restrict dst, dict_buffer_t* restrict drop )
+{
+    if ( dst->dense.on )
+    {
+        // the keys may get hashed again halfway
+        for ( size_t i = 0; i < drop->size; i += dst->key.size )
+        {
+            dict_take_key( dst, drop->data + i, NULL );
+        }
+    }
+    else
+    {
+        for ( size_t i = 0; i < drop->size; i += sizeof (dict_elem_t*) )
+        {
+            dict_elem_t* elem;
+            memcpy( &elem, drop->data + i, sizeof elem );
+            dict_drop_elem( dst, elem, NULL );
+        }
+    }
+    dict_free_mem( dst, drop->data, drop->cap );
+}
+
+
+bool dict_union( dict_t* restrict dst, const dict_t* restrict src )
+{
+    return dict_merge( dst, src, DICT_KEEP, NULL, NULL );
+}
+
+
+bool dict_intersect( dict_t* restrict dst, const dict_t* restrict src )
+{
+    if ( dict_merge_compatible( dst, src ) == false ) return false;
+    dict_log_pending( dst );
+
+    // every pair of `dst` has to be visited anyway, the ones missing from `src` are removed
+    dict_buffer_t    drop   = { 0 };
+    dict_cursor_t    cursor = { 0 };
+    dict_set_batch_t batch;
+    while ( dict_set_fill( dst, &cursor, &batch ) )
+    {
+        dict_set_probe( src, &batch );
+        for ( size_t i = 0; i < batch.len; i++ )
+        {
+            if ( batch.found[i] == false && dict_set_mark( dst, &drop, batch.items[i], batch.elems[i] ) == false )
+            {
+                dict_free_mem( dst, drop.data, drop.cap );
+                return false;
+            }
+        }
+    }
+    dict_set_drop( dst, &drop );
+    return true;
+}
+
+
+bool dict_difference( dict_t* restrict dst, const dict_t* restrict src )
+{
+    if ( dict_merge_compatible( dst, src ) == false ) return false;
+    dict_log_pending( dst );
+
+    // walk the smaller dict and look its keys up in the other one
+    bool             small  = src->len < dst->len;
+    dict_buffer_t    drop   = { 0 };
+    dict_cursor_t    cursor = { 0 };
+    dict_set_batch_t batch;
+    while ( dict_set_fill( small ? src : dst, &cursor, &batch ) )
+    {
+        dict_set_probe( small ? dst : src, &batch );
+        for ( size_t i = 0; i < batch.len; i++ )
+        {
+            if ( batch.found[i] && dict_set_mark( dst, &drop, batch.items[i], small ? batch.hits[i] : batch.elems[i] ) == false )
+            {
+                dict_free_mem( dst, drop.data, drop.cap );
+                return false;
+            }
+        }
+    }
+    dict_set_drop( dst, &drop );
+    return true;
+}
+
+
+bool dict_is_subset( const dict_t* restrict sub, const dict_t* restrict dict )
+{
+    if ( sub == dict ) return true;
+    if ( dict_merge_compatible( sub, dict ) == false || sub->len > dict->len ) return false;
+
+    dict_cursor_t    cursor = { 0 };
+    dict_set_batch_t batch;
+    while ( dict_set_fill( sub, &cursor, &batch ) )
+    {
+        dict_set_probe( dict, &batch );
+        for ( size_t i = 0; i < batch.len; i++ )
+        {
+            if ( batch.found[i] == false ) return false;
+        }
+    }
+    return true;
+}
+
+
+// remove every pair `pred` returns `match` for in a single pass, the buckets are shrunk once at the end
+static size_t dict_remove_match( dict_t* restrict dict, dict_pred pred, void* ctx, bool match )
+{
+    dict_log_pending( dict );
+
+    size_t removed = 0;
+    if ( dict->dense.on )
+    {
+        for ( size_t slot = 0; slot < dict->dense.span; slot++ )
+        {
+            if ( dict_dense_test( dict, slot ) == false ) continue;
+            char* item = dict_dense_slot( dict, slot );
+            if ( pred( item, item + dict->key.size, ctx ) != match ) continue;
+
+            if ( dict->log != NULL )
+            {
+                dict_log_record( dict, LOG_DEL, item );
+            }
+            dict->dense.bits[ slot / 64 ] &= ~( 1LLU << ( slot % 64 ) );
+            dict_free_val( dict, item + dict->key.size );
+            dict->len--;
+            removed++;
+        }
+        if ( dict->len == 0 )
+        {
+            dict_dense_release( dict );
+        }
+        else if ( removed != 0 && dict_dense_fits( dict, dict->len * 2, dict->dense.span - 1 ) == false )
+        {
+            dict_dense_to_hash( dict );
+        }
+        return removed;
+    }
+
+    for ( size_t i = 0; i < dict->mod; i++ )
+    {
+        dict_list_t* list = &dict->list[i];
+        bool         bin  = list->bin != NULL;
+        dict_elem_t* next;
+        for ( dict_elem_t* curr = list->head; curr != NULL; curr = next )
+        {
+            next = curr->next;
+            if ( pred( curr->key, dict_item_val( dict, curr->key ), ctx ) != match ) continue;
+
+            // the sorted index is built again for what is left of the chain
+            dict_snapshot_touch( dict, i );
+            if ( list->bin != NULL )
+            {
+                dict_bin_free( dict, list );
+            }
+            if ( dict->log != NULL )
+            {
+                dict_log_record( dict, LOG_DEL, curr->key );
+            }
+            dict_unlink_elem( dict, curr );
+            dict_release_elem( dict, curr, true );
+            removed++;
+        }
+        if ( bin && list->bin == NULL && list->size >= BIN_MIN )
+        {
+            dict_bin_build( dict, list );
+        }
+    }
+
+    // removed keys stay in the filter until it gets rebuilt, which shrinking does as well
+    size_t mod = dict->mod;
+    dict_shrink( dict );
+    if ( dict->filter.enable && mod == dict->mod && ( dict->filter.removed += removed ) > dict->filter.capacity / 2 )
+    {
+        dict_filter_rebuild( dict );
+    }
+    return removed;
+}
+
+
+size_t dict_remove_if( dict_t* restrict dict, dict_pred pred, void* ctx )
+{
+    return dict_remove_match( dict, pred, ctx, true );
+}
+
+
+size_t dict_retain( dict_t* restrict dict, dict_pred pred, void* ctx )
+{
+    return dict_remove_match( dict, pred, ctx, false );
+}
+
+
+// key `i` of the input, copied into the padding of `temp` if the stored key is larger
+static inline const void* dict_build_key( const dict_build_t* restrict build, size_t i, void* restrict temp )
+{
+    const dict_t* dict = build->dict;
+    const char*   key  = build->keys + i * dict->key_data;
+    if ( dict->key_data == dict->key.size )
+    {
+        return key;
+    }
+    memcpy( temp, key, dict->key_data );
+    return temp;
+}
+
+
+// val `i` of the input padded into `temp`, zeroed if no vals were provided
+static inline void* dict_build_val( const dict_build_t* restrict build, size_t i, void* restrict temp )
+{
+    memset( temp, 0, build->dict->val.size );
+    if ( build->vals != NULL )
+    {
+        memcpy( temp, build->vals + i * build->val_data, build->val_data );
+    }
+    return temp;
+}
+
+
+static inline size_t dict_build_part( const dict_build_t* restrict build, uint64_t code )
+{
+    return dict_elem_index( build->dict, code ) / build->width;
+}
+
+
+// phase 0 hashes and counts a slice of the input, phase 1 scatters it by partition, phase 2 fills the buckets of every `nthreads`th partition
+static void* dict_build_run( void* arg )
+{
+    dict_build_task_t* task  = arg;
+    dict_build_t*      build = task->build;
+    dict_t*            dict  = build->dict;
+    size_t*            count = build->count + task->id * build->parts;
+    size_t             first = build->n * task->id / build->nthreads;
+    size_t             last  = build->n * ( task->id + 1 ) / build->nthreads;
+
+    switch ( build->phase )
+    {
+        case 0:
+        {
+            for ( size_t i = first; i < last; i++ )
+            {
+                build->codes[i] = dict_get_hash( dict, dict_build_key( build, i, task->key ) );
+                count[ dict_build_part( build, build->codes[i] ) ]++;
+            }
+            break;
+        }
+        case 1:
+        {
+            for ( size_t i = first; i < last; i++ )
+            {
+                build->order[ count[ dict_build_part( build, build->codes[i] ) ]++ ] = i;
+            }
+            break;
+        }
+        default:
+        {
+            for ( size_t p = task->id; p < build->parts; p += build->nthreads )
+            {
+                for ( size_t k = build->bounds[p]; k < build->bounds[ p + 1 ]; k++ )
+                {
+                    size_t      i    = build->order[k];
+                    uint64_t    code = build->codes[i];
+                    const void* key  = dict_build_key( build, i, task->key );
+                    void*       val  = dict_build_val( build, i, task->val );
+
+                    dict_elem_t* elem = dict_find_elem( dict, key, code );
+                    if ( elem != NULL )
+                    {
+                        dict_merge_conflict( dict, dict, dict_item_val( dict, elem->key ), val, build->policy, build->combine, build->ctx, true );
+                        continue;
+                    }
+
+                    elem = dict_alloc_mem( dict, dict->node_size );
+                    ASSERT_MEM( elem );
+                    elem->code = code;
+                    dict_copy_key( dict, elem->key, key, code );
+                    memcpy( dict_item_val( dict, elem->key ), val, dict->val.size );
+                    if ( dict->ttl.enable )
+                    {
+                        dict_elem_expiry( dict, elem )->deadline = 0;
+                    }
+                    dict_list_t* list = &dict->list[ dict_elem_index( dict, code ) ];
+                    dict_list_append( list, elem );
+                    dict_bin_add( dict, list, elem );
+                    task->len++;
+                    if ( dict->dense.enable )
+                    {
+                        uint64_t pos = dict_dense_pos( dict, key );
+                        if ( pos < task->lo ) task->lo = pos;
+                        if ( pos > task->hi ) task->hi = pos;
+                    }
+                }
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+
+// run one phase on every task, the calling thread takes the first one
+static inline void dict_build_phase( dict_build_t* restrict build, dict_build_task_t* restrict tasks, int phase )
+{
+    build->phase = phase;
+    for ( size_t t = 1; t < build->nthreads; t++ )
+    {
+        tasks[t].spawned = pthread_create( &tasks[t].thread, NULL, dict_build_run, &tasks[t] ) == 0;
+    }
+    dict_build_run( &tasks[0] );
+    for ( size_t t = 1; t < build->nthreads; t++ )
+    {
+        // could not get a thread, run it here instead
+        if ( tasks[t].spawned )
+        {
+            pthread_join( tasks[t].thread, NULL );
+        }
+        else
+        {
+            dict_build_run( &tasks[t] );
+        }
+    }
+}
+
+
+// insert one by one, used when evicting pairs has to follow the input order and when the arena hands out the val slots
+static inline void dict_build_serial( dict_build_t* restrict build, dict_build_task_t* restrict task )
+{
+    dict_t* dict = build->dict;
+    for ( size_t i = 0; i < build->n; i++ )
+    {
+        bool  inserted;
+        void* src = dict_build_val( build, i, task->val );
+        void* val = dict_upsert_key( dict, dict_build_key( build, i, task->key ), &inserted );
+        ASSERT_MEM( val );
+        if ( inserted )
+        {
+            memcpy( val, src, dict->val.size );
+        }
+        else
+        {
+            dict_merge_conflict( dict, dict, val, src, build->policy, build->combine, build->ctx, true );
+        }
+    }
+}
+
+
+dict_t* dict_build( dict_args_t args, const void* keys, const void* vals, size_t n, size_t nthreads, dict_conflict_t policy, dict_combine combine, void* ctx )
+{
+    if ( policy == DICT_COMBINE && combine == NULL )
+    {
+        return NULL;
+    }
+
+    dict_t* dict = dict_init( args );
+    if ( n == 0 )
+    {
+        return dict;
+    }
+
+    nthreads = nthreads == 0 ? 1 : nthreads > n ? n : nthreads;
+    if ( dict->cache.enable || dict->arena.enable )
+    {
+        nthreads = 1;
+    }
+
+    dict_build_t build =
+    {
+        .dict       = dict,
+        .keys       = keys,
+        .vals       = vals,
+        .n          = n,
+        .val_data   = args.val.size,
+        .nthreads   = nthreads,
+        .parts      = nthreads * BUILD_PARTS,
+        .policy     = policy,
+        .combine    = combine,
+        .ctx        = ctx,
+    };
+
+    dict_build_task_t* tasks = dict_alloc_mem( dict, sizeof (dict_build_task_t) * nthreads );
+    ASSERT_MEM( tasks );
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        tasks[t] = (dict_build_task_t) { .build = &build, .id = t, .lo = UINT64_MAX };
+        tasks[t].key = dict_alloc_mem( dict, dict->key.size );
+        tasks[t].val = dict_alloc_mem( dict, dict->val.size + 1 );   // val may be empty
+        ASSERT_MEM( tasks[t].key );
+        ASSERT_MEM( tasks[t].val );
+        memset( tasks[t].key, 0, dict->key.size );
+    }
+
+    if ( dict->cache.enable || dict->arena.enable )
+    {
+        dict_build_serial( &build, tasks );
+    }
+    else
+    {
+        // hashed into buckets presized for all the keys, direct indexing is decided at the end
+        dict->dense.on = false;
+        if ( dict_presize( dict, n ) == false )
+        {
+            fprintf( stderr, "[ERRO]: out of memory.\n" );
+            exit(1);
+        }
+        build.width  = ( dict->mod + build.parts - 1 ) / build.parts;
+        build.codes  = dict_alloc_mem( dict, sizeof (uint64_t) * n );
+        build.order  = dict_alloc_mem( dict, sizeof (size_t) * n );
+        build.count  = dict_alloc_mem( dict, sizeof (size_t) * nthreads * build.parts );
+        build.bounds = dict_alloc_mem( dict, sizeof (size_t) * ( build.parts + 1 ) );
+        ASSERT_MEM( build.codes );
+        ASSERT_MEM( build.order );
+        ASSERT_MEM( build.count );
+        ASSERT_MEM( build.bounds );
+        memset( build.count, 0, sizeof (size_t) * nthreads * build.parts );
+
+        dict_build_phase( &build, tasks, 0 );
+
+        // partitions are laid out one after another, each one split by thread in input order
+        size_t offset = 0;
+        for ( size_t p = 0; p < build.parts; p++ )
+        {
+            build.bounds[p] = offset;
+            for ( size_t t = 0; t < nthreads; t++ )
+            {
+                size_t amount = build.count[ t * build.parts + p ];
+                build.count[ t * build.parts + p ] = offset;
+                offset += amount;
+            }
+        }
+        build.bounds[ build.parts ] = offset;
+
+        dict_build_phase( &build, tasks, 1 );
+        dict_build_phase( &build, tasks, 2 );
+
+        // the ordered index only learns about the nodes here, it is sorted by the first query anyway
+        for ( size_t i = 0; dict->order.enable && i < dict->mod; i++ )
+        {
+            for ( dict_elem_t* curr = dict->list[i].head; curr != NULL; curr = curr->next )
+            {
+                dict_order_add( dict, curr );
+            }
+        }
+        for ( size_t t = 0; t < nthreads; t++ )
+        {
+            dict->len += tasks[t].len;
+            if ( tasks[t].lo < dict->dense.lo ) dict->dense.lo = tasks[t].lo;
+            if ( tasks[t].hi > dict->dense.hi ) dict->dense.hi = tasks[t].hi;
+        }
+
+        dict_free_mem( dict, build.codes, sizeof (uint64_t) * n );
+        dict_free_mem( dict, build.order, sizeof (size_t) * n );
+        dict_free_mem( dict, build.count, sizeof (size_t) * nthreads * build.parts );
+        dict_free_mem( dict, build.bounds, sizeof (size_t) * ( build.parts + 1 ) );
+
+        if ( dict->filter.enable && dict_filter_rebuild( dict ) == false )
+        {
+            fprintf( stderr, "[ERRO]: out of memory.\n" );
+            exit(1);
+        }
+        if ( dict->dense.enable && dict_dense_fits( dict, dict->len, dict->dense.hi - dict->dense.lo ) )
+        {
+            dict_hash_to_dense( dict );
+        }
+    }
+
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        dict_free_mem( dict, tasks[t].key, dict->key.size );
+        dict_free_mem( dict, tasks[t].val, dict->val.size + 1 );
+    }
+    dict_free_mem( dict, tasks, sizeof (dict_build_task_t) * nthreads );
+
+    return dict;
+}
+
+
+static inline uint64_t dict_par_pack( uint64_t lo, uint64_t hi )
+{
+    return lo << 32 | hi;
+}
+
+
+// take the first chunk of the own range
+static inline bool dict_par_take( dict_par_range_t* restrict range, uint64_t* restrict chunk )
+{
+    uint64_t curr = atomic_load( &range->range );
+    while ( ( curr >> 32 ) < ( curr & UINT32_MAX ) )
+    {
+        if ( atomic_compare_exchange_weak( &range->range, &curr, curr + ( 1LLU << 32 ) ) )
+        {
+            *chunk = curr >> 32;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// move the upper half of the range of another worker into the own one, which is empty
+static inline bool dict_par_steal( dict_par_t* restrict par, size_t id )
+{
+    for ( size_t i = 1; i < par->nthreads; i++ )
+    {
+        dict_par_range_t* victim = &par->ranges[ ( id + i ) % par->nthreads ];
+        uint64_t curr = atomic_load( &victim->range );
+        while ( ( curr >> 32 ) < ( curr & UINT32_MAX ) )
+        {
+            uint64_t lo  = curr >> 32;
+            uint64_t hi  = curr & UINT32_MAX;
+            uint64_t mid = lo + ( hi - lo ) / 2;
+            if ( atomic_compare_exchange_weak( &victim->range, &curr, dict_par_pack( lo, mid ) ) )
+            {
+                atomic_store( &par->ranges[ id ].range, dict_par_pack( mid, hi ) );
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+static inline void dict_par_chunk( dict_par_t* restrict par, dict_par_task_t* restrict task, uint64_t chunk )
+{
+    dict_t* dict  = par->dict;
+    size_t  first = chunk * par->width;
+    size_t  last  = first + par->width < par->slots ? first + par->width : par->slots;
+    for ( size_t i = first; i < last; i++ )
+    {
+        if ( dict->dense.on )
+        {
+            if ( dict_dense_test( dict, i ) == false ) continue;
+            char* item = dict_dense_slot( dict, i );
+            if ( par->op == PAR_FOREACH ) par->each( item, dict_item_val( dict, item ), par->ctx );
+            else par->reduce( task->acc, item, dict_item_val( dict, item ), par->ctx );
+            continue;
+        }
+
+        dict_list_t* list = &dict->list[i];
+        if ( par->op == PAR_DESTROY )
+        {
+            dict_elem_t* next;
+            for ( dict_elem_t* curr = list->head; curr != NULL; curr = next )
+            {
+                next = curr->next;
+                dict_free_key( dict, curr->key );
+                if ( dict->val.size != 0 )
+                {
+                    dict_free_val( dict, dict_item_val( dict, curr->key ) );
+                }
+                dict_free_node( dict, curr );
+            }
+            dict_bin_free( dict, list );
+            *list = (dict_list_t) { 0 };
+            continue;
+        }
+        if ( par->op == PAR_FOREACH )
+        {
+            dict_snapshot_touch( dict, i );
+        }
+        for ( dict_elem_t* curr = list->head; curr != NULL; curr = curr->next )
+        {
+            if ( par->op == PAR_FOREACH ) par->each( curr->key, dict_item_val( dict, curr->key ), par->ctx );
+            else par->reduce( task->acc, curr->key, dict_item_val( dict, curr->key ), par->ctx );
+        }
+    }
+}
+
+
+static void* dict_par_run( void* arg )
+{
+    dict_par_task_t* task = arg;
+    dict_par_t*      par  = task->par;
+    uint64_t chunk;
+    do
+    {
+        while ( dict_par_take( &par->ranges[ task->id ], &chunk ) )
+        {
+            dict_par_chunk( par, task, chunk );
+        }
+    }
+    while ( dict_par_steal( par, task->id ) );
+    return NULL;
+}
+
+
+// split the buckets into chunks, every worker starts on its own share and steals from the others once done
+static bool dict_par_exec( dict_par_t* restrict par, size_t nthreads, void* result, size_t size, dict_combine combine )
+{
+    dict_t* dict  = par->dict;
+    par->slots    = dict->dense.on ? dict->dense.span : dict->mod;
+    par->nthreads = nthreads == 0 ? 1 : nthreads;
+    size_t chunks = par->nthreads * PAR_CHUNKS < par->slots ? par->nthreads * PAR_CHUNKS : par->slots;
+    if ( chunks == 0 ) return true;
+    par->width    = ( par->slots + chunks - 1 ) / chunks;
+    chunks        = ( par->slots + par->width - 1 ) / par->width;
+
+    dict_par_task_t* tasks = dict_alloc_mem( dict, sizeof (dict_par_task_t) * par->nthreads );
+    par->ranges = dict_alloc_aligned( dict, sizeof (dict_par_range_t) * par->nthreads, alignof (dict_par_range_t) );
+    if ( tasks == NULL || par->ranges == NULL )
+    {
+        if ( tasks != NULL ) dict_free_mem( dict, tasks, sizeof (dict_par_task_t) * par->nthreads );
+        if ( par->ranges != NULL ) dict_free_aligned( dict, par->ranges, sizeof (dict_par_range_t) * par->nthreads, alignof (dict_par_range_t) );
+        return false;
+    }
+
+    bool ok = true;
+    for ( size_t t = 0; t < par->nthreads; t++ )
+    {
+        tasks[t] = (dict_par_task_t) { .par = par, .id = t };
+        atomic_init( &par->ranges[t].range, dict_par_pack( chunks * t / par->nthreads, chunks * ( t + 1 ) / par->nthreads ) );
+        if ( par->op == PAR_REDUCE )
+        {
+            tasks[t].acc = dict_alloc_mem( dict, size );
+            if ( tasks[t].acc == NULL ) ok = false;
+            else memcpy( tasks[t].acc, result, size );
+        }
+    }
+
+    if ( ok )
+    {
+        for ( size_t t = 1; t < par->nthreads; t++ )
+        {
+            tasks[t].spawned = pthread_create( &tasks[t].thread, NULL, dict_par_run, &tasks[t] ) == 0;
+        }
+        dict_par_run( &tasks[0] );
+        for ( size_t t = 1; t < par->nthreads; t++ )
+        {
+            // could not get a thread, whatever was not stolen from it runs here
+            if ( tasks[t].spawned )
+            {
+                pthread_join( tasks[t].thread, NULL );
+            }
+            else
+            {
+                dict_par_run( &tasks[t] );
+            }
+        }
+    }
+
+    for ( size_t t = 0; t < par->nthreads && par->op == PAR_REDUCE; t++ )
+    {
+        if ( tasks[t].acc == NULL ) continue;
+        if ( ok ) combine( result, tasks[t].acc, par->ctx );
+        dict_free_mem( dict, tasks[t].acc, size );
+    }
+    dict_free_aligned( dict, par->ranges, sizeof (dict_par_range_t) * par->nthreads, alignof (dict_par_range_t) );
+    dict_free_mem( dict, tasks, sizeof (dict_par_task_t) * par->nthreads );
+    return ok;
+}
+
+
+bool dict_parallel_foreach( dict_t* restrict dict, dict_each each, void* ctx, size_t nthreads )
+{
+    dict_log_pending( dict );
+    dict_par_t par = { .dict = dict, .op = PAR_FOREACH, .each = each, .ctx = ctx };
+    return dict_par_exec( &par, nthreads, NULL, 0, NULL );
+}
+
+
+bool dict_parallel_reduce( const dict_t* restrict dict, void* restrict result, size_t size, dict_reduce reduce, dict_combine combine, void* ctx, size_t nthreads )
+{
+    dict_par_t par = { .dict = (dict_t*) dict, .op = PAR_REDUCE, .reduce = reduce, .ctx = ctx };
+    return dict_par_exec( &par, nthreads, result, size, combine );
+}
+
+
+static inline void dict_export_row( const dict_export_task_t* restrict task, size_t row, const char* restrict item )
+{
+    const dict_t* dict = task->dict;
+    if ( task->keys != NULL )
+    {
+        memcpy( task->keys + row * task->key_stride, item, dict->key_data );
+    }
+    if ( task->vals != NULL )
+    {
+        memcpy( task->vals + row * task->val_stride, dict_item_val( dict, item ), dict->val_data );
+    }
+}
+
+
+static void* dict_export_run( void* arg )
+{
+    dict_export_task_t* task = arg;
+    size_t row = task->row;
+    for ( size_t i = task->from; i < task->to && row < task->rows; i++ )
+    {
+        for ( dict_elem_t* elem = task->dict->list[i].head; elem != NULL && row < task->rows; elem = elem->next )
+        {
+            dict_export_row( task, row++, elem->key );
+        }
+    }
+    return NULL;
+}
+
+
+size_t dict_export( const dict_t* restrict dict, void* keys, size_t key_stride, void* vals, size_t val_stride, size_t capacity, size_t nthreads )
+{
+    dict_export_task_t base =
+    {
+        .dict       = dict,
+        .rows       = dict->len < capacity ? dict->len : capacity,
+        .keys       = keys,
+        .key_stride = key_stride != 0 ? key_stride : dict->key_data,
+        .vals       = dict->val_data != 0 ? vals : NULL,
+        .val_stride = val_stride != 0 ? val_stride : dict->val_data,
+    };
+
+    dict_export_task_t* tasks = NULL;
+    if ( dict->dense.on == false && nthreads > 1 && base.rows > 1 )
+    {
+        tasks = dict_alloc_mem( dict, sizeof (dict_export_task_t) * nthreads );
+    }
+    if ( tasks == NULL )
+    {
+        size_t        row    = 0;
+        dict_cursor_t cursor = { 0 };
+        for ( char* item = dict_next( dict, &cursor ); item != NULL && row < base.rows; item = dict_next( dict, &cursor ) )
+        {
+            dict_export_row( &base, row++, item );
+        }
+        return base.rows;
+    }
+
+    // the sizes of the chains tell where the rows of each share of the buckets start
+    size_t count = 1;
+    size_t seen  = 0;
+    tasks[0] = base;
+    for ( size_t i = 0; i < dict->mod && count < nthreads; i++ )
+    {
+        seen += dict->list[i].size;
+        if ( seen >= base.rows * count / nthreads )
+        {
+            tasks[ count - 1 ].to = i + 1;
+            tasks[ count ]        = base;
+            tasks[ count ].from   = i + 1;
+            tasks[ count ].row    = seen;
+            count++;
+        }
+    }
+    tasks[ count - 1 ].to = dict->mod;
+
+    for ( size_t t = 1; t < count; t++ )
+    {
+        tasks[t].spawned = pthread_create( &tasks[t].thread, NULL, dict_export_run, &tasks[t] ) == 0;
+    }
+    dict_export_run( &tasks[0] );
+    for ( size_t t = 1; t < count; t++ )
+    {
+        if ( tasks[t].spawned )
+        {
+            pthread_join( tasks[t].thread, NULL );
+        }
+        else
+        {
+            dict_export_run( &tasks[t] );
+        }
+    }
+    dict_free_mem( dict, tasks, sizeof (dict_export_task_t) * nthreads );
+    return base.rows;
+}
+
+
+size_t dict_export_str( const dict_t* restrict dict, uint64_t* restrict offsets, char* restrict blob, size_t* restrict bytes, void* vals, size_t val_stride, size_t capacity )
+{
+    size_t        used   = 0;
+    dict_cursor_t cursor = { 0 };
+    if ( dict->key.type != DICT_STR || dict->key.copy != NULL )
+    {
+        *bytes = 0;
+        return 0;
+    }
+
+    // only measure the blob
+    if ( blob == NULL )
+    {
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            used += dict_key_length( dict, *(char**) item );
+        }
+        *bytes = used;
+        return 0;
+    }
+
+    dict_export_task_t base = { .dict = dict, .vals = dict->val_data != 0 ? vals : NULL, .val_stride = val_stride != 0 ? val_stride : dict->val_data };
+    size_t row = 0;
+    offsets[0] = 0;
+    for ( char* item = dict_next( dict, &cursor ); item != NULL && row < capacity; item = dict_next( dict, &cursor ) )
+    {
+        const char* str    = *(char**) item;
+        size_t      length = dict_key_length( dict, str );
+        if ( used + length > *bytes ) break;
+        memcpy( blob + used, str, length );
+        used += length;
+        offsets[ row + 1 ] = used;
+        dict_export_row( &base, row++, item );
+    }
+    *bytes = used;
+    return row;
+}
+
+
+size_t dict_import( dict_t* restrict dict, const void* keys, size_t key_stride, const void* vals, size_t val_stride, size_t n )
+{
+    key_stride = key_stride != 0 ? key_stride : dict->key_data;
+    val_stride = val_stride != 0 ? val_stride : dict->val_data;
+    if ( dict_presize( dict, dict->len + n ) == false ) return 0;
+
+    size_t inserted = 0;
+    for ( size_t i = 0; i < n; i++ )
+    {
+        memcpy( dict->key_temp, (const char*) keys + i * key_stride, dict->key_data );
+        if ( vals != NULL )
+        {
+            inserted += dict_set_key( dict, dict->key_temp, (const char*) vals + i * val_stride );
+            continue;
+        }
+        bool  fresh;
+        void* val = dict_upsert_key( dict, dict->key_temp, &fresh );
+        ASSERT_MEM( val );
+        inserted += fresh;
+    }
+    return inserted;
+}
+
+
+size_t dict_import_str( dict_t* restrict dict, const uint64_t* restrict offsets, const char* restrict blob, const void* vals, size_t val_stride, size_t n )
+{
+    if ( dict->key.type != DICT_STR || dict->key.copy != NULL ) return 0;
+    val_stride = val_stride != 0 ? val_stride : dict->val_data;
+    if ( dict_presize( dict, dict->len + n ) == false ) return 0;
+
+    // every key is terminated in a buffer of its own, which the dict copies on insertion
+    size_t cap = 0;
+    char*  str = NULL;
+    size_t inserted = 0;
+    for ( size_t i = 0; i < n; i++ )
+    {
+        size_t length = offsets[ i + 1 ] - offsets[i];
+        if ( length + 1 > cap )
+        {
+            size_t grow = cap == 0 ? 64 : cap;
+            while ( grow < length + 1 )
+            {
+                grow *= DEFAULT_STEP;
+            }
+            char* temp = dict_realloc_mem( dict, str, cap, grow );
+            ASSERT_MEM( temp );
+            str = temp;
+            cap = grow;
+        }
+        memcpy( str, blob + offsets[i], length );
+        str[ length ] = '\0';
+
+        if ( vals != NULL )
+        {
+            inserted += dict_set_key( dict, &str, (const char*) vals + i * val_stride );
+            continue;
+        }
+        bool  fresh;
+        void* val = dict_upsert_key( dict, &str, &fresh );
+        ASSERT_MEM( val );
+        inserted += fresh;
+    }
+    if ( str != NULL )
+    {
+        dict_free_mem( dict, str, cap );
+    }
+    return inserted;
+}
+
+
+void dict_destroy_parallel( dict_t* restrict dict, size_t nthreads )
+{
+    assert( dict->snap == NULL );
+    dict_log_close( dict );
+
+    // the nodes go first, the rest is left to `dict_destroy`
+    if ( dict->dense.on == false )
+    {
+        dict_par_t par = { .dict = dict, .op = PAR_DESTROY };
+        dict_par_exec( &par, nthreads, NULL, 0, NULL );
+    }
+    dict_destroy( dict );
+}
+
+
+size_t dict_range( dict_t* restrict dict, dict_visit visit, void* ctx, ... )
+{
+    if ( dict->order.enable == false ) return 0;
+
+    va_list ap;
+    va_start( ap, ctx );
+
+    // the lower bound is moved out of `key_temp` before the upper one is read
+    memcpy( dict->order.bound, dict_get_key( dict, ap ), dict->key.size );
+    void* hi = dict_get_key( dict, ap );
+
+    va_end(ap);
+
+    dict_order_refresh( dict );
+
+    size_t count = 0;
+    for ( size_t i = dict_order_search( dict, dict->order.bound ); i < dict->order.len; i++ )
+    {
+        dict_elem_t* elem = dict->order.items[i];
+        if ( dict_order_cmpr( dict, elem->key, hi ) > 0 ) break;
+        count++;
+        if ( visit != NULL && visit( elem->key, dict_item_val( dict, elem->key ), ctx ) == false ) break;
+    }
+    return count;
+}
+
+
+size_t dict_prefix( dict_t* restrict dict, const char* prefix, dict_visit visit, void* ctx )
+{
+    if ( dict->order.enable == false || dict->key.type != DICT_STR || dict->key.copy != NULL ) return 0;
+
+    dict_order_refresh( dict );
+
+    size_t length = strlen( prefix );
+    size_t count  = 0;
+    for ( size_t i = dict_order_search( dict, &prefix ); i < dict->order.len; i++ )
+    {
+        dict_elem_t* elem = dict->order.items[i];
+        if ( strncmp( *(char**) elem->key, prefix, length ) != 0 ) break;
+        count++;
+        if ( visit != NULL && visit( elem->key, dict_item_val( dict, elem->key ), ctx ) == false ) break;
+    }
+    return count;
+}
+
+
+static void* dict_snapshot_run( void* arg )
+{
+    dict_snapshot_t* snap = arg;
+    dict_buffer_t    out;
+
+    for ( size_t i = 0; i < snap->mod; i += SNAPSHOT_BATCH )
+    {
+        pthread_mutex_lock( &snap->lock );
+        for ( size_t j = i; j < i + SNAPSHOT_BATCH && j < snap->mod; j++ )
+        {
+            if ( atomic_load_explicit( &snap->done[j], memory_order_relaxed ) == 0 )
+            {
+                dict_snapshot_copy( snap, j );
+            }
+        }
+
+        // hand the records out without holding the lock
+        out = (dict_buffer_t) { 0 };
+        if ( snap->write != NULL && snap->items.size >= SNAPSHOT_FLUSH )
+        {
+            out = snap->items;
+            snap->items = (dict_buffer_t) { 0 };
+        }
+        pthread_mutex_unlock( &snap->lock );
+
+        if ( out.data != NULL )
+        {
+            if ( snap->failed == false && snap->write( out.data, out.size, snap->ctx ) == false )
+            {
+                snap->failed = true;
+            }
+            dict_free_mem( snap->dict, out.data, out.cap );
+        }
+    }
+
+    if ( snap->write != NULL && snap->failed == false )
+    {
+        if ( ( snap->items.size != 0 && snap->write( snap->items.data, snap->items.size, snap->ctx ) == false ) ||
+             ( snap->strs.size  != 0 && snap->write( snap->strs.data,  snap->strs.size,  snap->ctx ) == false ) )
+        {
+            snap->failed = true;
+        }
+    }
+
+    return NULL;
+}
+
+
+dict_snapshot_t* dict_snapshot_begin( dict_t* restrict dict, dict_writer write, void* ctx )
+{
+    if ( dict->snap != NULL ) return NULL;
+
+    dict_snapshot_t* snap = dict_alloc_mem( dict, sizeof (dict_snapshot_t) );
+    if ( snap == NULL ) return NULL;
+    *snap = (dict_snapshot_t)
+    {
+        .dict   = dict,
+        .mod    = dict->mod,
+        .write  = write,
+        .ctx    = ctx,
+        .header = { dict->key.size, dict->val.size, dict->len },
+    };
+
+    snap->done = dict_alloc_mem( dict, sizeof (atomic_uchar) * ( snap->mod + 1 ) );
+    if ( snap->done == NULL )
+    {
+        dict_free_mem( dict, snap, sizeof (dict_snapshot_t) );
+        return NULL;
+    }
+    // the pairs of a direct-indexed dict are copied below, the buckets it may move them into later count as done
+    for ( size_t i = 0; i < snap->mod; i++ )
+    {
+        atomic_init( &snap->done[i], dict->dense.on );
+    }
+    pthread_mutex_init( &snap->lock, NULL );
+
+    if ( write != NULL )
+    {
+        dict_buffer_push( dict, &snap->items, snap->header, sizeof (uint32_t) * 3 );
+    }
+
+    // the slot array is not split into buckets, it is copied right away
+    if ( dict->dense.on )
+    {
+        dict_cursor_t cursor = { 0 };
+        for ( char* item = dict_next( dict, &cursor ); item != NULL; item = dict_next( dict, &cursor ) )
+        {
+            dict_snapshot_item( snap, item );
+        }
+    }
+
+    dict->snap = snap;
+    if ( pthread_create( &snap->thread, NULL, dict_snapshot_run, snap ) != 0 )
+    {
+        dict->snap = NULL;
+        pthread_mutex_destroy( &snap->lock );
+        if ( snap->items.data != NULL ) dict_free_mem( dict, snap->items.data, snap->items.cap );
+        if ( snap->strs.data != NULL )  dict_free_mem( dict, snap->strs.data, snap->strs.cap );
+        dict_free_mem( dict, snap->done, sizeof (atomic_uchar) * ( snap->mod + 1 ) );
+        dict_free_mem( dict, snap, sizeof (dict_snapshot_t) );
+        return NULL;
+    }
+    return snap;
+}
+
+
+bool dict_snapshot_end( dict_snapshot_t* restrict snap, void** restrict data, size_t* restrict bytes )
+{
+    pthread_join( snap->thread, NULL );
+
+    dict_t* dict = snap->dict;
+    dict->snap = NULL;
+
+    // the data is only gathered for a caller that takes it
+    bool ok = snap->failed == false;
+    if ( ok && snap->write == NULL && data != NULL )
+    {
+        // same layout as `dict_serialize`
+        size_t size = sizeof (uint32_t) * 3 + snap->items.size + snap->strs.size;
+        char* ptr = dict_alloc_mem( dict, size );
+        if ( ptr == NULL )
+        {
+            ok = false;
+        }
+        else
+        {
+            memcpy( ptr, snap->header, sizeof (uint32_t) * 3 );
+            if ( snap->items.size != 0 ) memcpy( ptr + sizeof (uint32_t) * 3, snap->items.data, snap->items.size );
+            if ( snap->strs.size != 0 )  memcpy( ptr + sizeof (uint32_t) * 3 + snap->items.size, snap->strs.data, snap->strs.size );
+            *data = ptr;
+            if ( bytes != NULL ) *bytes = size;
+        }
+    }
+
+    pthread_mutex_destroy( &snap->lock );
+    if ( snap->items.data != NULL ) dict_free_mem( dict, snap->items.data, snap->items.cap );
+    if ( snap->strs.data != NULL )  dict_free_mem( dict, snap->strs.data, snap->strs.cap );
+    dict_free_mem( dict, snap->done, sizeof (atomic_uchar) * ( snap->mod + 1 ) );
+    dict_free_mem( dict, snap, sizeof (dict_snapshot_t) );
+
+    // resizing was put off while the snapshot was running
+    if ( dict_presize( dict, dict->len ) == false )
+    {
+        ok = false;
+    }
+
+    return ok;
+}
+
+
+bool dict_log_open( dict_t* restrict dict, const char* restrict path, size_t batch )
+{
+    // keys with inner allocation can not be encoded
+    if ( dict->log != NULL || dict->key.copy != NULL ) return false;
+
+    dict_log_t* log = dict_alloc_mem( dict, sizeof (dict_log_t) );
+    if ( log == NULL ) return false;
+    *log = (dict_log_t) { .batch = batch != 0 ? batch : LOG_BATCH };
+
+    log->path   = dict_alloc_mem( dict, strlen( path ) + 1 );
+    log->before = dict_alloc_mem( dict, dict->val.size + 1 );
+    log->fp     = fopen( path, "ab" );
+    if ( log->path == NULL || log->before == NULL || log->fp == NULL )
+    {
+        if ( log->fp != NULL ) fclose( log->fp );
+        if ( log->path != NULL ) dict_free_mem( dict, log->path, strlen( path ) + 1 );
+        if ( log->before != NULL ) dict_free_mem( dict, log->before, dict->val.size + 1 );
+        dict_free_mem( dict, log, sizeof (dict_log_t) );
+        return false;
+    }
+    strcpy( log->path, path );
+
+    dict->log = log;
+    return true;
+}
+
+
+bool dict_log_sync( dict_t* restrict dict )
+{
+    if ( dict->log == NULL ) return false;
+    dict_log_pending( dict );
+    return dict_log_write( dict );
+}
+
+
+bool dict_log_close( dict_t* restrict dict )
+{
+    if ( dict->log == NULL ) return false;
+
+    bool ok = dict_log_sync( dict );
+    dict_log_t* log = dict->log;
+    dict->log = NULL;
+
+    if ( fclose( log->fp ) != 0 ) ok = false;
+    if ( log->records.data != NULL ) dict_free_mem( dict, log->records.data, log->records.cap );
+    dict_free_mem( dict, log->before, dict->val.size + 1 );
+    dict_free_mem( dict, log->path, strlen( log->path ) + 1 );
+    dict_free_mem( dict, log, sizeof (dict_log_t) );
+    return ok;
+}
+
+
+bool dict_log_compact( dict_t* restrict dict, const char* restrict snapshot )
+{
+    if ( dict_log_sync( dict ) == false ) return false;
+
+    size_t bytes;
+    void* data = dict_serialize( dict, &bytes );
+    if ( data == NULL ) return false;
+
+    // write the new snapshot aside first, so a crash leaves the old snapshot and the log intact
+    size_t length = strlen( snapshot );
+    char* temp = dict_alloc_mem( dict, length + 5 );
+    if ( temp == NULL )
+    {
+        dict_free_mem( dict, data, bytes );
+        return false;
+    }
+    memcpy( temp, snapshot, length );
+    memcpy( temp + length, ".tmp", 5 );
+
+    FILE* fp = fopen( temp, "wb" );
+    bool ok = fp != NULL;
+    if ( ok )
+    {
+        ok = fwrite( data, 1, bytes, fp ) == bytes && fflush( fp ) == 0 && dict_fsync( fp ) == 0;
+        ok = fclose( fp ) == 0 && ok;
+    }
+    ok = ok && rename( temp, snapshot ) == 0;
+    dict_free_mem( dict, temp, length + 5 );
+    dict_free_mem( dict, data, bytes );
+    if ( ok == false ) return false;
+
+    // everything in the log is now part of the snapshot
+    dict_log_t* log = dict->log;
+    fp = freopen( log->path, "wb", log->fp );
+    if ( fp == NULL )
+    {
+        log->failed = true;
+        return false;
+    }
+    log->fp = fp;
+    return true;
+}
+
+
+static inline void* dict_read_file( const dict_t* restrict dict, const char* restrict path, size_t* restrict bytes )
+{
+    FILE* fp = fopen( path, "rb" );
+    if ( fp == NULL ) return NULL;
+
+    fseek( fp, 0, SEEK_END );
+    long size = ftell( fp );
+    fseek( fp, 0, SEEK_SET );
+
+    void* data = size > 0 ? dict_alloc_mem( dict, size ) : NULL;
+    if ( data != NULL && fread( data, 1, size, fp ) != (size_t) size )
+    {
+        dict_free_mem( dict, data, size );
+        data = NULL;
+    }
+    fclose( fp );
+    *bytes = data != NULL ? (size_t) size : 0;
+    return data;
+}
+
+
+dict_t* dict_recover( dict_args_t args, const char* restrict snapshot, const char* restrict log )
+{
+    dict_t* dict = dict_create( args );
+    if ( dict->key.copy != NULL )
+    {
+        dict_destroy( dict );
+        return NULL;
+    }
+
+    size_t bytes;
+    void*  data = snapshot != NULL ? dict_read_file( dict, snapshot, &bytes ) : NULL;
+    if ( data != NULL )
+    {
+        dict_t* load = dict_deserialize( args, data );
+        dict_free_mem( dict, data, bytes );
+        dict_destroy( dict );
+        if ( load == NULL ) return NULL;
+        dict = load;
+    }
+
+    data = log != NULL ? dict_read_file( dict, log, &bytes ) : NULL;
+    if ( data == NULL ) return dict;
+
+    // replay the records, a record cut short by a crash ends the log
+    const char* ptr = data;
+    const char* end = ptr + bytes;
+    char*       str = NULL;
+    while ( end - ptr >= (ptrdiff_t) ( sizeof (uint8_t) + sizeof (uint32_t) ) )
+    {
+        uint8_t  op = *(uint8_t*) ptr;
+        uint32_t length;
+        memcpy( &length, ptr + sizeof (uint8_t), sizeof (uint32_t) );
+        const char* key = ptr + sizeof (uint8_t) + sizeof (uint32_t);
+        size_t size = sizeof (uint8_t) + sizeof (uint32_t) + length + ( op == LOG_PUT ? dict->val.size : 0 );
+        if ( ( op != LOG_PUT && op != LOG_DEL ) || (size_t) ( end - ptr ) < size ) break;
+
+        if ( dict->key.type == DICT_STR )
+        {
+            if ( str != NULL ) dict_free_mem( dict, str, strlen( str ) + 1 );
+            str = dict_alloc_mem( dict, length + 1 );
+            ASSERT_MEM( str );
+            memcpy( str, key, length );
+            str[ length ] = 0;
+            memcpy( dict->key_temp, &str, sizeof (char*) );
+        }
+        else
+        {
+            memcpy( dict->key_temp, key, dict->key.size );
+        }
+
+        if ( op == LOG_PUT )
+        {
+            void* val = dict_upsert_key( dict, dict->key_temp, NULL );
+            ASSERT_MEM( val );
+            memcpy( val, key + length, dict->val.size );
+        }
+        else
+        {
+            dict_take_key( dict, dict->key_temp, NULL );
+        }
+        ptr += size;
+    }
+    if ( str != NULL ) dict_free_mem( dict, str, strlen( str ) + 1 );
+    dict_free_mem( dict, data, bytes );
+
+    return dict;
+}
+
+
+// lookup of a reader, without any write to memory shared with the writer or the other readers
+static inline dict_elem_t* dict_read_elem( const dict_t* restrict dict, const void* restrict key, uint64_t code )
+{
+    while ( true )
+    {
+        uint64_t seq = atomic_load_explicit( &dict->swmr.seq, memory_order_acquire );
+        if ( seq & 1 )
+        {
+            sched_yield();
+            continue;
+        }
+
+        // `mod` first, the `list` published with it is at least as large
+        size_t       mod  = dict_load( &dict->mod );
+        dict_list_t* list = dict_load( &dict->list );
+        for ( dict_elem_t* curr = dict_load( &list[ code & ( mod - 1 ) ].head ); curr != NULL; curr = dict_load( &curr->next ) )
+        {
+            if ( curr->code == code && dict_key_equal( dict, curr->key, key ) )
+            {
+                return curr;
+            }
+        }
+
+        // a miss only counts if no node was moved by a reshape meanwhile
+        atomic_thread_fence( memory_order_acquire );
+        if ( atomic_load_explicit( &dict->swmr.seq, memory_order_relaxed ) == seq )
+        {
+            return NULL;
+        }
+    }
+}
+
+
+dict_reader_t* dict_reader_join( dict_t* restrict dict )
+{
+    if ( dict->swmr.enable == false ) return NULL;
+
+    dict_reader_t* reader = dict_alloc_aligned( dict, sizeof (dict_reader_t), alignof (dict_reader_t) );
+    if ( reader == NULL ) return NULL;
+    reader->key_temp = dict_alloc_mem( dict, dict->key.size );
+    if ( reader->key_temp == NULL )
+    {
+        dict_free_aligned( dict, reader, sizeof (dict_reader_t), alignof (dict_reader_t) );
+        return NULL;
+    }
+    memset( reader->key_temp, 0, dict->key.size );
+    atomic_init( &reader->epoch, 0 );
+    reader->dict = dict;
+    reader->prev = NULL;
+
+    pthread_mutex_lock( &dict->swmr.lock );
+    reader->next = dict->swmr.readers;
+    if ( reader->next != NULL )
+    {
+        reader->next->prev = reader;
+    }
+    dict->swmr.readers = reader;
+    pthread_mutex_unlock( &dict->swmr.lock );
+    return reader;
+}
+
+
+void dict_reader_leave( dict_reader_t* restrict reader )
+{
+    dict_t* dict = reader->dict;
+    pthread_mutex_lock( &dict->swmr.lock );
+    if ( reader->prev != NULL )
+    {
+        reader->prev->next = reader->next;
+    }
+    else
+    {
+        dict->swmr.readers = reader->next;
+    }
+    if ( reader->next != NULL )
+    {
+        reader->next->prev = reader->prev;
+    }
+    pthread_mutex_unlock( &dict->swmr.lock );
+
+    dict_free_mem( dict, reader->key_temp, dict->key.size );
+    dict_free_aligned( dict, reader, sizeof (dict_reader_t), alignof (dict_reader_t) );
+}
+
+
+void dict_read_begin( dict_reader_t* restrict reader )
+{
+    // published before any node is read, so the writer either sees this epoch or the reader sees the unlinks
+    atomic_store_explicit( &reader->epoch, atomic_load( &reader->dict->swmr.epoch ), memory_order_release );
+    atomic_thread_fence( memory_order_seq_cst );
+}
+
+
+void dict_read_end( dict_reader_t* restrict reader )
+{
+    atomic_store_explicit( &reader->epoch, 0, memory_order_release );
+}
+
+
+const void* dict_read_find( dict_reader_t* restrict reader, ... )
+{
+    const dict_t* dict = reader->dict;
+    va_list ap;
+    va_start( ap, reader );
+
+    void* key = dict_read_key( dict, reader->key_temp, ap );
+
+    va_end(ap);
+
+    dict_elem_t* elem = dict_read_elem( dict, key, dict_get_hash( dict, key ) );
+    return elem != NULL ? dict_item_val( dict, elem->key ) : NULL;
+}
+
+
+bool dict_read_has( dict_reader_t* restrict reader, ... )
+{
+    const dict_t* dict = reader->dict;
+    va_list ap;
+    va_start( ap, reader );
+
+    void* key = dict_read_key( dict, reader->key_temp, ap );
+
+    va_end(ap);
+
+    return dict_read_elem( dict, key, dict_get_hash( dict, key ) ) != NULL;
+}
+
+
+#define AGG_FOLD(T,op,d,s) \
+    do { T* d_ = (T*) (d); T s_ = *(const T*) (s); *d_ = (op) == DICT_AGG_SUM ? *d_ + s_ : (op) == DICT_AGG_MIN ? ( s_ < *d_ ? s_ : *d_ ) : ( s_ > *d_ ? s_ : *d_ ); } while (0)
+
+// fold the val `src` into `dest`, `ctx` is the aggregation of the dict
+static void dict_agg_fold( void* dest, const void* src, void* ctx )
+{
+    const dict_agg_t* agg = ctx;
+    if ( agg->op == DICT_AGG_CALL )
+    {
+        agg->combine( dest, src, agg->ctx );
+        return;
+    }
+    switch ( agg->type )
+    {
+        case DICT_I32:  AGG_FOLD( int32_t,  agg->op, dest, src );   break;
+        case DICT_U32:  AGG_FOLD( uint32_t, agg->op, dest, src );   break;
+        case DICT_F32:  AGG_FOLD( float,    agg->op, dest, src );   break;
+        case DICT_I64:  AGG_FOLD( int64_t,  agg->op, dest, src );   break;
+        case DICT_U64:  AGG_FOLD( uint64_t, agg->op, dest, src );   break;
+        case DICT_F64:  AGG_FOLD( double,   agg->op, dest, src );   break;
+        default:        break;
+    }
+}
+
+
+// plain hashed dict with the key and val attributes of `dict`, so its nodes can be moved into it as they are
+static inline dict_t* dict_agg_table( const dict_t* restrict dict )
+{
+    dict_key_attr_t key = dict->key;
+    key.size = dict->key_data;
+    return dict_init( (dict_args_t)
+    {
+        .key    = key,
+        .val    = { .size = dict->val_data, .free = dict->val.free },
+        .alloc  = dict->alloc,
+    });
+}
+
+
+dict_local_t* dict_agg_join( dict_t* restrict dict )
+{
+    if ( dict->agg.enable == false ) return NULL;
+
+    dict_local_t* local = dict_alloc_mem( dict, sizeof (dict_local_t) );
+    if ( local == NULL ) return NULL;
+    memset( local, 0, sizeof (dict_local_t) );
+    local->dict = dict;
+    return local;
+}
+
+
+bool dict_agg_add( dict_local_t* restrict local, const void* restrict val, ... )
+{
+    if ( local->table == NULL )
+    {
+        local->table = dict_agg_table( local->dict );
+    }
+    dict_t* table = local->table;
+    va_list ap;
+    va_start( ap, val );
+
+    void* key = dict_get_key( table, ap );
+
+    va_end(ap);
+
+    // a hot key is folded without walking its chain
+    uint64_t      code = dict_get_hash( table, key );
+    dict_elem_t** hot  = &local->hot[ code & ( AGG_HOT - 1 ) ];
+    dict_elem_t*  elem = *hot;
+    if ( elem == NULL || elem->code != code || dict_key_equal( table, elem->key, key ) == false )
+    {
+        elem = dict_find_elem( table, key, code );
+        if ( elem == NULL )
+        {
+            char* item = dict_insert_elem( table, key, code, val );
+            if ( item == NULL ) return false;
+            *hot = (dict_elem_t*) ( item - table->key.size - offsetof( dict_elem_t, key ) );
+            return true;
+        }
+        *hot = elem;
+    }
+    dict_agg_fold( elem->key + table->key.size, val, &local->dict->agg );
+    return true;
+}
+
+
+bool dict_agg_flush( dict_local_t* restrict local )
+{
+    if ( local->table == NULL ) return true;
+
+    dict_agg_t* agg = &local->dict->agg;
+    pthread_mutex_lock( &agg->lock );
+    bool done = dict_buffer_push( local->dict, &agg->pending, &local->table, sizeof (dict_t*) );
+    pthread_mutex_unlock( &agg->lock );
+    if ( done == false ) return false;
+
+    local->table = NULL;
+    memset( local->hot, 0, sizeof local->hot );
+    return true;
+}
+
+
+void dict_agg_leave( dict_local_t* restrict local )
+{
+    if ( dict_agg_flush( local ) == false )
+    {
+        dict_destroy( local->table );
+    }
+    dict_free_mem( local->dict, local, sizeof (dict_local_t) );
+}
+
+
+bool dict_agg_merge( dict_t* restrict dict )
+{
+    if ( dict->agg.enable == false ) return false;
+
+    // collect the tables at once, so threads flushing meanwhile only wait for the swap
+    pthread_mutex_lock( &dict->agg.lock );
+    dict_buffer_t pending = dict->agg.pending;
+    dict->agg.pending = (dict_buffer_t) { 0 };
+    pthread_mutex_unlock( &dict->agg.lock );
+
+    dict_t** tables = (dict_t**) pending.data;
+    bool     done   = true;
+    for ( size_t i = 0; i < pending.size / sizeof (dict_t*); i++ )
+    {
+        done = done && dict_merge_move( dict, tables[i], DICT_COMBINE, dict_agg_fold, &dict->agg );
+        dict_destroy( tables[i] );
+    }
+    if ( tables != NULL ) dict_free_mem( dict, tables, pending.cap );
+    return done;
+}
+
+
+// node of `key`, NULL if the key is not in the dict or the dict has no expiry
+static inline dict_elem_t* dict_ttl_find( dict_t* restrict dict, va_list ap )
+{
+    if ( dict->ttl.enable == false ) return NULL;
+    void* key = dict_get_key( dict, ap );
+    return dict_filter_find( dict, key, dict_get_hash( dict, key ) );
+}
+
+
+bool dict_expire( dict_t* restrict dict, uint64_t ttl, ... )
+{
+    va_list ap;
+    va_start( ap, ttl );
+
+    dict_elem_t* elem = dict_ttl_find( dict, ap );
+
+    va_end(ap);
+
+    if ( elem == NULL ) return false;
+    uint64_t deadline = dict->ttl.now( dict->ttl.ctx ) + ttl;
+    dict_ttl_set( dict, elem, deadline != 0 ? deadline : 1 );
+    return true;
+}
+
+
+bool dict_persist( dict_t* restrict dict, ... )
+{
+    va_list ap;
+    va_start( ap, dict );
+
+    dict_elem_t* elem = dict_ttl_find( dict, ap );
+
+    va_end(ap);
+
+    if ( elem == NULL ) return false;
+    dict_ttl_set( dict, elem, 0 );
+    return true;
+}
+
+
+uint64_t dict_expiry( dict_t* restrict dict, ... )
+{
+    va_list ap;
+    va_start( ap, dict );
+
+    dict_elem_t* elem = dict_ttl_find( dict, ap );
+
+    va_end(ap);
+
+    return elem != NULL ? dict_elem_expiry( dict, elem )->deadline : 0;
+}
+
+
+size_t dict_expire_tick( dict_t* restrict dict, size_t budget )
+{
+    if ( dict->ttl.enable == false ) return 0;
+    return dict_ttl_reclaim( dict, budget );
+}
+
+
+#ifdef DICT_PROFILE
+bool dict_profile_start( dict_t* restrict dict, uint32_t sample )
+{
+    if ( dict->prof == NULL )
+    {
+        dict->prof = dict_alloc_mem( dict, sizeof (dict_prof_t) );
+        if ( dict->prof == NULL ) return false;
+    }
+    memset( dict->prof, 0, sizeof (dict_prof_t) );
+    dict->prof->data.sample = sample != 0 ? sample : 1;
+    dict->prof->left        = dict->prof->data.sample;
+    return true;
+}
+
+
+void dict_profile_stop( dict_t* restrict dict )
+{
+    if ( dict->prof == NULL ) return;
+    dict_free_mem( dict, dict->prof, sizeof (dict_prof_t) );
+    dict->prof = NULL;
+}
+
+
+const dict_profile_t* dict_profile( const dict_t* restrict dict )
+{
+    return dict->prof != NULL ? &dict->prof->data : NULL;
+}
+
+
+bool dict_profile_dump( const dict_t* restrict dict, FILE* restrict fp )
+{
+    if ( dict->prof == NULL ) return false;
+
+    static const char* names[ DICT_PROF_OPS ] = { "get", "find", "remove", "reshape", "serialize" };
+    const dict_profile_t* data = &dict->prof->data;
+    fprintf( fp, "sampled 1 in %u, latencies in ns\n", data->sample );
+    fprintf( fp, "%-10s %12s %10s %10s %10s %10s %10s %12s\n", "op", "count", "mean", "p50", "p90", "p99", "p99.9", "max" );
+    for ( size_t op = 0; op < DICT_PROF_OPS; op++ )
+    {
+        const dict_prof_hist_t* hist = &data->ops[ op ];
+        fprintf( fp, "%-10s %12llu %10llu %10llu %10llu %10llu %10llu %12llu\n", names[ op ], (unsigned long long) hist->count,
+                 (unsigned long long) ( hist->count != 0 ? hist->total / hist->count : 0 ),
+                 (unsigned long long) dict_profile_percentile( hist, 0.5 ), (unsigned long long) dict_profile_percentile( hist, 0.9 ),
+                 (unsigned long long) dict_profile_percentile( hist, 0.99 ), (unsigned long long) dict_profile_percentile( hist, 0.999 ),
+                 (unsigned long long) hist->max );
+    }
+
+    // the latest resizes, oldest first
+    uint64_t first = data->resizes > DICT_PROF_RESIZES ? data->resizes - DICT_PROF_RESIZES : 0;
+    fprintf( fp, "resizes: %llu\n", (unsigned long long) data->resizes );
+    for ( uint64_t i = first; i < data->resizes; i++ )
+    {
+        const dict_prof_resize_t* resize = &data->resize[ i % DICT_PROF_RESIZES ];
+        fprintf( fp, "%12llu: %zu -> %zu buckets, %zu pairs, %llu ns\n", (unsigned long long) i, resize->from, resize->to, resize->len, (unsigned long long) resize->nanos );
+    }
+    return ferror( fp ) == 0;
+}
+
+#else
+
+bool dict_profile_start( dict_t* restrict dict, uint32_t sample )
+{
+    (void) dict; (void) sample;
+    return false;
+}
+
+
+void dict_profile_stop( dict_t* restrict dict )
+{
+    (void) dict;
+}
+
+
+const dict_profile_t* dict_profile( const dict_t* restrict dict )
+{
+    (void) dict;
+    return NULL;
+}
+
+
+bool dict_profile_dump( const dict_t* restrict dict, FILE* restrict fp )
+{
+    (void) dict; (void) fp;
+    return false;
+}
+
+#endif  // DICT_PROFILE
+
+
+uint64_t dict_profile_bound( size_t bucket )
+{
+    if ( bucket < PROF_SUBS ) return bucket;
+    return (uint64_t) ( PROF_SUBS + bucket % PROF_SUBS ) << ( bucket / PROF_SUBS - 1 );
+}
+
+
+uint64_t dict_profile_percentile( const dict_prof_hist_t* restrict hist, double q )
+{
+    if ( hist->count == 0 ) return 0;
+
+    // rank of the sample looked for, counting from 1
+    uint64_t rank = (uint64_t) ( q * hist->count );
+    rank += rank < q * hist->count;
+    rank  = rank < 1 ? 1 : rank > hist->count ? hist->count : rank;
+
+    uint64_t seen = 0;
+    for ( size_t i = 0; i < DICT_PROF_BUCKETS; i++ )
+    {
+        seen += hist->buckets[i];
+        if ( seen >= rank )
+        {
+            // the largest latency the bucket may hold
+            uint64_t upper = dict_profile_bound( i + 1 ) - 1;
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+#ifndef _WIN32
+
+// blocks are multiples of SHM_ALIGN up to SHM_SMALL and powers of two above, every size has its own free list
+static inline size_t dict_shm_block( size_t size, size_t* restrict class )
+{
+    size = ( size + ( SHM_ALIGN - 1 ) ) & ~( (size_t) SHM_ALIGN - 1 );
+    if ( size <= SHM_SMALL )
+    {
+        *class = size / SHM_ALIGN - 1;
+        return size;
+    }
+    size_t block = SHM_SMALL * 2;
+    *class = SHM_SMALL / SHM_ALIGN;
+    while ( block < size )
+    {
+        block <<= 1;
+        ++*class;
+    }
+    return block;
+}
+
+
+// offset of a new block, or 0 if the region is full
+static inline uint64_t dict_shm_alloc( dict_shm_t* restrict shm, size_t size )
+{
+    dict_shm_head_t* head = shm->head;
+    size_t class;
+    size_t block = dict_shm_block( size, &class );
+    if ( class >= SHM_CLASSES ) return 0;
+
+    uint64_t offset = head->free[ class ];
+    if ( offset != 0 )
+    {
+        memcpy( &head->free[ class ], shm->base + offset, sizeof (uint64_t) );
+        return offset;
+    }
+    if ( block > head->bytes - head->top ) return 0;
+    offset = head->top;
+    head->top += block;
+    return offset;
+}
+
+
+static inline void dict_shm_dealloc( dict_shm_t* restrict shm, uint64_t offset, size_t size )
+{
+    size_t class;
+    dict_shm_block( size, &class );
+    memcpy( shm->base + offset, &shm->head->free[ class ], sizeof (uint64_t) );
+    shm->head->free[ class ] = offset;
+}
+
+
+static inline dict_shm_elem_t* dict_shm_elem( const dict_shm_t* restrict shm, uint64_t offset )
+{
+    return (dict_shm_elem_t*) ( shm->base + offset );
+}
+
+
+// key of a node the way the dict functions expect it, the string of a DICT_STR key is pointed to by `str`
+static inline const void* dict_shm_key( const dict_shm_t* restrict shm, const dict_shm_elem_t* restrict elem, char** restrict str )
+{
+    if ( shm->proto.key.type != DICT_STR ) return elem->key;
+    uint64_t offset;
+    memcpy( &offset, elem->key, sizeof offset );
+    *str = shm->base + offset;
+    return str;
+}
+
+
+// link pointing to the node of `key`, or to the end of its chain
+static inline uint64_t* dict_shm_link( const dict_shm_t* restrict shm, const void* restrict key, uint64_t code )
+{
+    const dict_shm_head_t* head = shm->head;
+    uint64_t* link = (uint64_t*) ( shm->base + head->buckets ) + ( code & ( head->mod - 1 ) );
+    while ( *link != 0 )
+    {
+        dict_shm_elem_t* elem = dict_shm_elem( shm, *link );
+        char* str;
+        if ( elem->code == code && dict_key_equal( &shm->proto, dict_shm_key( shm, elem, &str ), key ) ) break;
+        link = &elem->next;
+    }
+    return link;
+}
+
+
+// double the buckets, the chains just get longer if the region has no room for it
+static inline void dict_shm_grow( dict_shm_t* restrict shm )
+{
+    dict_shm_head_t* head = shm->head;
+    size_t   mod    = head->mod * DEFAULT_STEP;
+    uint64_t offset = dict_shm_alloc( shm, sizeof (uint64_t) * mod );
+    if ( offset == 0 ) return;
+
+    uint64_t* list = (uint64_t*) ( shm->base + offset );
+    uint64_t* old  = (uint64_t*) ( shm->base + head->buckets );
+    memset( list, 0, sizeof (uint64_t) * mod );
+    for ( size_t i = 0; i < head->mod; i++ )
+    {
+        uint64_t curr = old[i];
+        while ( curr != 0 )
+        {
+            dict_shm_elem_t* elem = dict_shm_elem( shm, curr );
+            uint64_t next  = elem->next;
+            uint64_t index = elem->code & ( mod - 1 );
+            elem->next  = list[ index ];
+            list[ index ] = curr;
+            curr = next;
+        }
+    }
+    dict_shm_dealloc( shm, head->buckets, sizeof (uint64_t) * head->mod );
+    head->buckets = offset;
+    head->mod     = mod;
+}
+
+
+// val of `key`, inserted zeroed if it was not there. Return NULL if the region is full, must hold the write lock
+static inline char* dict_shm_put( dict_shm_t* restrict shm, const void* restrict key, bool* restrict inserted )
+{
+    dict_shm_head_t* head = shm->head;
+    uint64_t  code = dict_get_hash( &shm->proto, key );
+    uint64_t* link = dict_shm_link( shm, key, code );
+    *inserted = *link == 0;
+    if ( *link != 0 )
+    {
+        return dict_shm_elem( shm, *link )->key + shm->proto.key.size;
+    }
+
+    uint64_t offset = dict_shm_alloc( shm, shm->node_size );
+    if ( offset == 0 ) return NULL;
+    dict_shm_elem_t* elem = dict_shm_elem( shm, offset );
+    if ( shm->proto.key.type == DICT_STR )
+    {
+        const char* str = *(char**) key;
+        size_t length = strlen( str ) + 1;
+        uint64_t data = dict_shm_alloc( shm, length );
+        if ( data == 0 )
+        {
+            dict_shm_dealloc( shm, offset, shm->node_size );
+            return NULL;
+        }
+        memcpy( shm->base + data, str, length );
+        memcpy( elem->key, &data, sizeof data );
+    }
+    else
+    {
+        memcpy( elem->key, key, shm->proto.key.size );
+    }
+    char* val = elem->key + shm->proto.key.size;
+    memset( val, 0, shm->proto.val.size );
+    elem->code = code;
+    elem->next = 0;
+    *link = offset;
+
+    if ( ++head->len > head->mod * DEFAULT_LOAD )
+    {
+        dict_shm_grow( shm );
+    }
+    return val;
+}
+
+
+// handle of a mapped region, the region is unmapped if the key does not match the one it was created with
+static dict_shm_t* dict_shm_attach( dict_key_attr_t key, void* base, size_t bytes )
+{
+    dict_shm_head_t* head = base;
+    if ( key.copy != NULL || bytes < sizeof (dict_shm_head_t) || atomic_load( &head->magic ) != SHM_MAGIC || head->key_type != key.type
+         || head->key_data != ( key.type == DICT_STRUCT ? key.size : dict_key_size( key ) ) )
+    {
+        munmap( base, bytes );
+        return NULL;
+    }
+
+    dict_shm_t* shm = malloc( sizeof (dict_shm_t) );
+    ASSERT_MEM( shm );
+    memset( &shm->proto, 0, sizeof (dict_t) );
+    shm->proto.alloc    = dict_alloc_init( (dict_alloc_t) { 0 }, &shm->proto.alloc );
+    shm->proto.key      = key;
+    shm->proto.key.size = dict_key_size( key );
+    shm->proto.key.pool = NULL;
+    shm->proto.val      = (dict_val_attr_t) { .size = dict_val_size( (dict_val_attr_t) { .size = head->val_data } ) };
+    shm->proto.key_data = head->key_data;
+    shm->proto.key_temp = dict_alloc_mem( &shm->proto, shm->proto.key.size );
+    ASSERT_MEM( shm->proto.key_temp );
+    memset( shm->proto.key_temp, 0, shm->proto.key.size );
+
+    shm->head       = head;
+    shm->base       = base;
+    shm->node_size  = sizeof (dict_shm_elem_t) + shm->proto.key.size + shm->proto.val.size;
+    return shm;
+}
+
+
+dict_shm_t* dict_shm_create( const char* restrict name, dict_key_attr_t key, size_t val_size, size_t bytes )
+{
+    // an anonymous region gets a unique name that is unlinked right away, the mapping is inherited by `fork`
+    static atomic_uint serial;
+    char temp[64];
+    const char* path = name;
+    if ( name == NULL )
+    {
+        snprintf( temp, sizeof temp, "/dict-%ld-%u", (long) getpid(), atomic_fetch_add( &serial, 1 ) );
+        path = temp;
+    }
+    if ( key.copy != NULL || bytes < sizeof (dict_shm_head_t) + sizeof (uint64_t) * DEFAULT_MOD + SHM_ALIGN ) return NULL;
+
+    int fd = shm_open( path, O_RDWR | O_CREAT | O_EXCL, 0600 );
+    if ( fd < 0 ) return NULL;
+    void* base = MAP_FAILED;
+    if ( ftruncate( fd, bytes ) == 0 )
+    {
+        base = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+    if ( base == MAP_FAILED || name == NULL )
+    {
+        shm_unlink( path );
+    }
+    if ( base == MAP_FAILED ) return NULL;
+
+    dict_shm_head_t* head = base;
+    head->key_type  = key.type;
+    head->key_data  = key.type == DICT_STRUCT ? key.size : dict_key_size( key );
+    head->val_data  = val_size;
+    head->bytes     = bytes;
+    head->len       = 0;
+    head->mod       = DEFAULT_MOD;
+    head->top       = ( sizeof (dict_shm_head_t) + ( SHM_ALIGN - 1 ) ) & ~( (size_t) SHM_ALIGN - 1 );
+    memset( head->free, 0, sizeof head->free );
+
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init( &attr );
+    pthread_rwlockattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+    int err = pthread_rwlock_init( &head->lock, &attr );
+    pthread_rwlockattr_destroy( &attr );
+    if ( err != 0 )
+    {
+        munmap( base, bytes );
+        if ( name != NULL ) shm_unlink( name );
+        return NULL;
+    }
+    atomic_store( &head->magic, SHM_MAGIC );
+
+    dict_shm_t* shm = dict_shm_attach( key, base, bytes );
+    head->buckets = dict_shm_alloc( shm, sizeof (uint64_t) * head->mod );
+    memset( shm->base + head->buckets, 0, sizeof (uint64_t) * head->mod );
+    return shm;
+}
+
+
+dict_shm_t* dict_shm_open( const char* restrict name, dict_key_attr_t key )
+{
+    int fd = shm_open( name, O_RDWR, 0 );
+    if ( fd < 0 ) return NULL;
+    struct stat st;
+    void* base = MAP_FAILED;
+    if ( fstat( fd, &st ) == 0 && st.st_size > 0 )
+    {
+        base = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+    if ( base == MAP_FAILED ) return NULL;
+
+    return dict_shm_attach( key, base, st.st_size );
+}
+
+
+void dict_shm_close( dict_shm_t* restrict shm )
+{
+    munmap( shm->base, shm->head->bytes );
+    dict_free_mem( &shm->proto, shm->proto.key_temp, shm->proto.key.size );
+    free( shm );
+}
+
+
+bool dict_shm_unlink( const char* restrict name )
+{
+    return shm_unlink( name ) == 0;
+}
+
+
+bool dict_shm_set( dict_shm_t* restrict shm, const void* restrict val, ... )
+{
+    va_list ap;
+    va_start( ap, val );
+    void* key = dict_get_key( &shm->proto, ap );
+    va_end( ap );
+
+    bool inserted;
+    pthread_rwlock_wrlock( &shm->head->lock );
+    char* dest = dict_shm_put( shm, key, &inserted );
+    if ( dest != NULL ) memcpy( dest, val, shm->head->val_data );
+    pthread_rwlock_unlock( &shm->head->lock );
+    return dest != NULL;
+}
+
+
+bool dict_shm_update( dict_shm_t* restrict shm, dict_val_init update, void* ctx, ... )
+{
+    va_list ap;
+    va_start( ap, ctx );
+    void* key = dict_get_key( &shm->proto, ap );
+    va_end( ap );
+
+    bool inserted;
+    pthread_rwlock_wrlock( &shm->head->lock );
+    char* val = dict_shm_put( shm, key, &inserted );
+    if ( val != NULL ) update( key, val, ctx );
+    pthread_rwlock_unlock( &shm->head->lock );
+    return val != NULL;
+}
+
+
+bool dict_shm_find( dict_shm_t* restrict shm, void* restrict val, ... )
+{
+    va_list ap;
+    va_start( ap, val );
+    void* key = dict_get_key( &shm->proto, ap );
+    va_end( ap );
+
+    // hashed before taking the lock, so readers only hold it for the walk
+    uint64_t code = dict_get_hash( &shm->proto, key );
+    pthread_rwlock_rdlock( &shm->head->lock );
+    uint64_t link = *dict_shm_link( shm, key, code );
+    if ( link != 0 && val != NULL )
+    {
+        memcpy( val, dict_shm_elem( shm, link )->key + shm->proto.key.size, shm->head->val_data );
+    }
+    pthread_rwlock_unlock( &shm->head->lock );
+    return link != 0;
+}
+
+
+bool dict_shm_remove( dict_shm_t* restrict shm, ... )
+{
+    va_list ap;
+    va_start( ap, shm );
+    void* key = dict_get_key( &shm->proto, ap );
+    va_end( ap );
+
+    uint64_t code = dict_get_hash( &shm->proto, key );
+    pthread_rwlock_wrlock( &shm->head->lock );
+    uint64_t* link   = dict_shm_link( shm, key, code );
+    uint64_t  offset = *link;
+    if ( offset != 0 )
+    {
+        dict_shm_elem_t* elem = dict_shm_elem( shm, offset );
+        *link = elem->next;
+        if ( shm->proto.key.type == DICT_STR )
+        {
+            char* str;
+            dict_shm_key( shm, elem, &str );
+            dict_shm_dealloc( shm, str - shm->base, strlen( str ) + 1 );
+        }
+        dict_shm_dealloc( shm, offset, shm->node_size );
+        shm->head->len--;
+    }
+    pthread_rwlock_unlock( &shm->head->lock );
+    return offset != 0;
+}
+
+
+size_t dict_shm_len( dict_shm_t* restrict shm )
+{
+    pthread_rwlock_rdlock( &shm->head->lock );
+    size_t len = shm->head->len;
+    pthread_rwlock_unlock( &shm->head->lock );
+    return len;
+}
+
+
+bool dict_shm_load( dict_shm_t* restrict shm, const dict_t* restrict dict )
+{
+    if ( dict->key.type != shm->proto.key.type || dict->key.size != shm->proto.key.size || dict->val.size != shm->proto.val.size ) return false;
+
+    bool ok = true;
+    bool inserted;
+    dict_cursor_t cursor = { 0 };
+    pthread_rwlock_wrlock( &shm->head->lock );
+    for ( char* item = dict_next( dict, &cursor ); item != NULL && ok; item = dict_next( dict, &cursor ) )
+    {
+        char* val = dict_shm_put( shm, item, &inserted );
+        if ( val != NULL ) memcpy( val, dict_item_val( dict, item ), shm->head->val_data );
+        ok = val != NULL;
+    }
+    pthread_rwlock_unlock( &shm->head->lock );
+    return ok;
+}
+
+#else
+
+// no POSIX shared memory
+dict_shm_t* dict_shm_create( const char* restrict name, dict_key_attr_t key, size_t val_size, size_t bytes )
+{
+    (void) name; (void) key; (void) val_size; (void) bytes;
+    return NULL;
+}
+
+
+dict_shm_t* dict_shm_open( const char* restrict name, dict_key_attr_t key )
+{
+    (void) name; (void) key;
+    return NULL;
+}
+
+
+void dict_shm_close( dict_shm_t* restrict shm )
+{
+    (void) shm;
+}
+
+
+bool dict_shm_unlink( const char* restrict name )
+{
+    (void) name;
+    return false;
+}
+
+
+bool dict_shm_set( dict_shm_t* restrict shm, const void* restrict val, ... )
+{
+    (void) shm; (void) val;
+    return false;
+}
+
+
+bool dict_shm_update( dict_shm_t* restrict shm, dict_val_init update, void* ctx, ... )
+{
+    (void) shm; (void) update; (void) ctx;
+    return false;
+}
+
+
+bool dict_shm_find( dict_shm_t* restrict shm, void* restrict val, ... )
+{
+    (void) shm; (void) val;
+    return false;
+}
+
+
+bool dict_shm_remove( dict_shm_t* restrict shm, ... )
+{
+    (void) shm;
+    return false;
+}
+
+
+size_t dict_shm_len( dict_shm_t* restrict shm )
+{
+    (void) shm;
+    return 0;
+}
+
+
+bool dict_shm_load( dict_shm_t* restrict shm, const dict_t* restrict dict )
+{
+    (void) shm; (void) dict;
+    return false;
 }
 
+#endif  // _WIN32
@@ -34,15 +34,40 @@ typedef void (*dict_desctructor)( void* ptr );                      // needs to
 typedef int (*dict_cmpr)( const void* ptr1, const void* ptr2 );     // used to compare if key is equal, return 0 if equal. 
 typedef uint64_t (*dict_hash)( const void* ptr );                   // return the hash code of the type. Two equal object should return the same code. 
 
+typedef void (*dict_val_init)( const void* key, void* val, void* ctx );   // initialize the val of a newly inserted pair
+typedef void (*dict_evict)( const void* key, void* val, void* ctx );  // called with a pair evicted from a cache, before `val.free` runs
+
+typedef void (*dict_combine)( void* dest, const void* src, void* ctx ); // merge the val `src` into the val `dest` of the same key
+
+typedef bool (*dict_visit)( const void* key, const void* val, void* ctx );   // receive a pair in key order, return false to stop
+typedef bool (*dict_pred)( const void* key, const void* val, void* ctx );    // return true if the pair matches
+
+typedef void (*dict_each)( const void* key, void* val, void* ctx );                 // receive a pair of a parallel pass, may modify the val
+typedef void (*dict_reduce)( void* acc, const void* key, const void* val, void* ctx );  // fold a pair into the partial result `acc` of a thread
+
+typedef uint64_t (*dict_now)( void* ctx );                           // return the current time, in the unit expiry times are given in, never going backwards
+
+typedef bool (*dict_writer)( const void* data, size_t bytes, void* ctx );  // receive a chunk of encoded data, return false to abort
+
 typedef void* (*dict_malloc)( size_t size );                        // malloc for custom allocator
 typedef void  (*dict_free)( void* ptr );                            // free for custom alloc
 
+typedef void* (*dict_alloc)( void* ctx, size_t size, size_t align );                                   // allocate `size` bytes aligned to `align`
+typedef void  (*dict_dealloc)( void* ctx, void* ptr, size_t size );                                     // release `size` bytes obtained from `alloc`
+typedef void* (*dict_realloc)( void* ctx, void* ptr, size_t old_size, size_t new_size, size_t align );  // resize a block obtained from `alloc`, keeping its content
+
 typedef struct
 {
     dict_malloc    malloc;      // must be provided if a custom allocator is desired
     dict_free      free;        // not necessary, because things like an arena alloc may not have a free function
+    void*          ctx;         // passed to `alloc`, `dealloc` and `realloc`
+    dict_alloc     alloc;       // context aware allocator, used instead of `malloc` and `free` if provided
+    dict_dealloc   dealloc;     // optional, receives the size of every block given back, including bucket arrays replaced by a resize
+    dict_realloc   realloc;     // optional, `alloc` and `dealloc` are used instead if not provided
 } dict_alloc_t;
 
+typedef struct dict_pool dict_pool_t;
+
 typedef struct
 {
     dict_type_t         type;
@@ -51,42 +76,288 @@ typedef struct
     dict_desctructor    free;   // only needed if copy is provided
     dict_hash           hash;
     dict_cmpr           cmpr;
+    dict_pool_t*        pool;   // optional, DICT_STR keys are interned in the pool instead of copied. Ignored if copy or hash is provided. 
 } dict_key_attr_t;
 
 typedef struct
 {
     size_t              size;
     dict_desctructor    free;   // free the inside alloation, the value address space is managed by the library. 
+    bool                split;  // keep the vals in an arena apart from the nodes, so walking the buckets only touches keys and hash codes. Vals keep their address until removed, `dense` and `swmr` are ignored in this mode
 } dict_val_attr_t;
 
+typedef struct
+{
+    bool                enable; // keep DICT_CHAR, DICT_WCHAR, DICT_I32, DICT_U32, DICT_I64, DICT_U64 keys in a direct-indexed array while their range is dense. Address returned by `dict_get` is only valid until the next insertion in this mode.
+    double              fill;   // minimal ratio between the amount of keys and the size of their range to stay direct-indexed, 0.25 if not provided
+} dict_dense_attr_t;
+
+typedef struct
+{
+    bool                enable; // check a blocked bloom filter before walking the buckets, so most misses are answered from one cache line
+    uint32_t            bits;   // bits per key, 10 if not provided
+} dict_filter_attr_t;
+
+typedef struct
+{
+    size_t              max_len;    // maximal amount of pairs, 0 for no limit
+    size_t              max_bytes;  // maximal memory used by nodes and DICT_STR keys, 0 for no limit
+    dict_evict          evict;      // optional, receives every evicted pair
+    void*               ctx;        // passed to `evict`
+} dict_cache_attr_t;
+
+typedef struct
+{
+    bool                enable;     // keep the keys sorted for `dict_range` and `dict_prefix`, `dense` is ignored in this mode
+    dict_cmpr           cmpr;       // ordering of the keys, returns negative, 0 or positive like `strcmp`. Natural order of the type if not provided
+} dict_order_attr_t;
+
+typedef struct
+{
+    bool                enable;     // one writer thread and any amount of reader threads using `dict_read_find` without locks, `dense` is ignored in this mode
+    size_t              batch;      // removed nodes and replaced bucket arrays are freed in batches, once no reader can see them anymore. 64 if not provided
+} dict_swmr_attr_t;
+
+typedef struct
+{
+    bool                enable;     // pairs may be given an expiry time with `dict_expire`, `dense` and `swmr` are ignored in this mode
+    dict_now            now;        // clock the expiry times are measured by, milliseconds of CLOCK_MONOTONIC if not provided
+    void*               ctx;        // passed to `now`
+    size_t              budget;     // expired pairs reclaimed by every insertion, 4 if not provided
+} dict_ttl_attr_t;
+
+typedef enum
+{
+    DICT_AGG_SUM,       // add the vals
+    DICT_AGG_MIN,       // keep the smallest val
+    DICT_AGG_MAX,       // keep the largest val
+    DICT_AGG_CALL,      // merge them with a `dict_combine` callback
+} dict_agg_op_t;
+
+typedef struct
+{
+    bool                enable;     // threads fold vals into local tables of their own with `dict_agg_add`, which are merged into the dict later, `swmr` is ignored in this mode
+    dict_agg_op_t       op;         // how two vals of the same key are folded
+    dict_type_t         type;       // type of the val for the built-in ops, one of DICT_I32, DICT_U32, DICT_F32, DICT_I64, DICT_U64, DICT_F64
+    dict_combine        combine;    // for DICT_AGG_CALL
+    void*               ctx;        // passed to `combine`
+} dict_agg_attr_t;
+
+typedef enum
+{
+    DICT_KEEP,          // keep the val already in the destination
+    DICT_OVERWRITE,     // replace it with the val from the source, the replaced val is freed
+    DICT_COMBINE,       // merge both with a `dict_combine` callback
+} dict_conflict_t;
+
 typedef struct
 {
     dict_key_attr_t     key;    // key attribute
     dict_val_attr_t     val;    // val attribute
     dict_alloc_t        alloc;  // cumstom alloc set for dict
+    dict_dense_attr_t   dense;  // direct-indexed mode for integer keys, falls back to hashing automatically when the keys get sparse
+    dict_filter_attr_t  filter; // approximate membership filter for miss heavy workloads
+    dict_cache_attr_t   cache;  // bounded cache with CLOCK eviction when a limit is set, `dense` is ignored in this mode
+    dict_order_attr_t   order;  // ordered index, sorted lazily by the first query after a batch of insertions
+    dict_swmr_attr_t    swmr;   // single writer, many lock free readers
+    dict_agg_attr_t     agg;    // per-thread aggregation, e.g. counting events from many threads
+    dict_ttl_attr_t     ttl;    // per pair expiry, reclaimed through a timing wheel
 } dict_args_t;
 
+typedef struct
+{
+    size_t              len;                // amount of pairs
+    size_t              buckets;            // amount of buckets, 0 while direct-indexed, 1 until the dict holds more than 8 pairs
+    size_t              longest;            // length of the longest chain
+    size_t              bins;               // chains long enough to be searched through a sorted index
+    bool                dense;              // keys are currently direct-indexed
+    uint64_t            filter_queries;     // lookups checked against the filter, `dict_has` is not counted
+    uint64_t            filter_negatives;   // lookups answered by the filter without touching the buckets
+    uint64_t            filter_false;       // lookups passed by the filter for keys not in the dict
+    double              filter_fpr;         // false positive rate of the filter among keys not in the dict
+} dict_stats_t;
+
+typedef enum
+{
+    DICT_PROF_GET,          // dict_get, dict_upsert, dict_get_or_init, dict_set and dict_get_prehashed
+    DICT_PROF_FIND,         // dict_find and dict_find_prehashed
+    DICT_PROF_REMOVE,       // dict_remove, dict_take and dict_remove_prehashed
+    DICT_PROF_RESHAPE,      // every resize of the buckets, not sampled
+    DICT_PROF_SERIALIZE,    // dict_serialize, not sampled
+    DICT_PROF_OPS,
+} dict_prof_op_t;
+
+#define DICT_PROF_BUCKETS   512     // log-bucketed, 8 buckets per power of two
+#define DICT_PROF_RESIZES   64      // latest resizes kept
+
+typedef struct
+{
+    uint64_t            count;      // amount of samples
+    uint64_t            total;      // sum of the samples in nanoseconds
+    uint64_t            max;        // slowest sample in nanoseconds
+    uint64_t            buckets[ DICT_PROF_BUCKETS ];   // samples from `dict_profile_bound(i)` up to `dict_profile_bound(i + 1)` nanoseconds
+} dict_prof_hist_t;
+
+typedef struct
+{
+    uint64_t            nanos;      // time taken by the resize
+    size_t              from;       // buckets before
+    size_t              to;         // buckets after
+    size_t              len;        // amount of pairs moved
+} dict_prof_resize_t;
+
+typedef struct
+{
+    uint32_t            sample;     // one in `sample` operations is timed
+    dict_prof_hist_t    ops[ DICT_PROF_OPS ];
+    uint64_t            resizes;    // amount of resizes, the latest one is at `resize[ ( resizes - 1 ) % DICT_PROF_RESIZES ]`
+    dict_prof_resize_t  resize[ DICT_PROF_RESIZES ];
+} dict_profile_t;
+
 typedef struct dict dict_t;
+typedef struct dict_snapshot dict_snapshot_t;
+typedef struct dict_shm dict_shm_t;
+typedef struct dict_reader dict_reader_t;
+typedef struct dict_local dict_local_t;
 
 
 // function
-dict_t*     dict_create( dict_args_t args );                                    // dictionary constructor, return a pointer of `dict_t`
+dict_t*     dict_create( dict_args_t args );                                    // dictionary constructor, return a pointer of `dict_t`. An empty dict is a single allocation, up to 8 pairs share one bucket inside it. 
 dict_t*     dict_new( dict_type_t key_type, size_t key_size, size_t val_size ); // dictionary constructor, return a pointer of `dict_t`. Easier to use, but with less control. 
 void        dict_destroy( dict_t* dict );                                       // dictionary destructor. Free the memory used by dict, also free each key and value if destructor provided. 
+void        dict_destroy_parallel( dict_t* dict, size_t nthreads );             // same as `dict_destroy`, the pairs are freed by up to `nthreads` threads. `alloc`, `key.free` and `val.free` must be thread safe. 
 void*       dict_get( dict_t* dict, /* T key */... );                           // for DICT_STRUCT, pass in the address of the struct. Return the address of `val` to the corresponding `key`. Create new key-val pair if the input key was not in the dictionary. 
 bool        dict_remove( dict_t* dict, /* T key */... );                        // for DICT_STRUCT, pass in the address of the struct. Return true if key deleted and it was in the dict. 
-bool        dict_has( const dict_t* dict, /* T key */... );                     // for DICT_STRUCT, pass in the address of the struct. Return true if key is in the dict. 
+bool        dict_has( const dict_t* dict, /* T key */... );                     // for DICT_STRUCT, pass in the address of the struct. Return true if key is in the dict. Leaves the dict as it is, an expired key is not reclaimed. 
+void*       dict_find( dict_t* dict, /* T key */... );                          // return the address of `val` to the corresponding `key`, or NULL if the key is not in the dict. Never inserts. 
+void*       dict_upsert( dict_t* dict, bool* inserted, /* T key */... );        // same as `dict_get`, `inserted` is set to true if the key was not in the dict. 
+void*       dict_get_or_init( dict_t* dict, dict_val_init init, void* ctx, /* T key */... );   // same as `dict_get`, `init` runs on the zeroed val only if the key was inserted. 
+bool        dict_set( dict_t* dict, const void* val, /* T key */... );        // copy `val` into the val of `key`, an existing val is freed first. Return true if the key was not in the dict. 
+bool        dict_take( dict_t* dict, void* val, /* T key */... );               // move the val into `val` and remove the key, `val.free` is not called. Return false if the key was not in the dict. 
 size_t      dict_len( const dict_t* dict );                                     // return the total amount of pairs exist in the dict
-const void* dict_key( const dict_t* dict, size_t* size );                       // return an array contains all the keys of the dict unordered. The array is allocated by `alloc.malloc` if specified, otherwise libc malloc is used. Don't change the key in the array since shallow copy is used. 
-void*       dict_serialize( const dict_t* dict, size_t* bytes );                // return the pointer to the encoded data, allocated using specified `malloc`. 
+const void* dict_key( const dict_t* dict, size_t* size );                       // return an array contains all the keys of the dict unordered. The array is allocated by `alloc` if specified, otherwise libc malloc is used. Don't change the key in the array since shallow copy is used. 
+void*       dict_serialize( const dict_t* dict, size_t* bytes );                // return the pointer to the encoded data, allocated by `alloc` if specified, otherwise libc malloc is used. With `val.split`, the vals are written as one block after the keys. 
 dict_t*     dict_deserialize( dict_args_t args, const void* data );             // this function does not free `data`, you still need to free `data` if necessary. 
+dict_t*     dict_build( dict_args_t args, const void* keys, const void* vals, size_t n, size_t nthreads, dict_conflict_t policy, dict_combine combine, void* ctx );    // build a dict from `n` keys and `n` vals laid out as arrays, using up to `nthreads` threads. `vals` may be NULL for zeroed vals. Vals are copied bytewise and owned by the dict, a val dropped by `policy` is freed. `alloc`, `key.copy`, `key.hash` and `combine` must be thread safe. 
+dict_stats_t dict_stats( const dict_t* dict );                                  // return the counters and the shape of the dict. 
+
+// columnar export and import, keys and vals are copied to and from caller-provided arrays of rows. A stride of 0 packs the rows, `key.size` bytes for DICT_STRUCT and the size of the type otherwise for keys, `val.size` bytes for vals. Either column may be NULL. 
+size_t      dict_export( const dict_t* dict, void* keys, size_t key_stride, void* vals, size_t val_stride, size_t capacity, size_t nthreads );    // write up to `capacity` pairs in one pass, using up to `nthreads` threads. Rows come in the order of `dict_next`, DICT_STR keys are written as the `char*` the dict owns. Return the amount of rows written. 
+size_t      dict_export_str( const dict_t* dict, uint64_t* offsets, char* blob, size_t* bytes, void* vals, size_t val_stride, size_t capacity );    // DICT_STR keys only. If `blob` is NULL, `bytes` receives the size of every key together. Otherwise write up to `capacity` keys without terminators into the `bytes` bytes of `blob`, key `i` going from `offsets[i]` to `offsets[i + 1]`, and set `bytes` to the bytes used. Return the amount of rows written. 
+size_t      dict_import( dict_t* dict, const void* keys, size_t key_stride, const void* vals, size_t val_stride, size_t n );   // insert `n` rows, the buckets are grown once up front. Existing vals are freed and replaced like `dict_set`, if `vals` is NULL new keys get zeroed vals and existing ones are kept. Return the amount of keys inserted. 
+size_t      dict_import_str( dict_t* dict, const uint64_t* offsets, const char* blob, const void* vals, size_t val_stride, size_t n );    // same as `dict_import`, the DICT_STR keys come in the layout written by `dict_export_str`. 
+
+// lookups with a hash code computed once by `dict_hash_key`, e.g. to probe several dicts with the same key. There is no per dict seed, dicts with the same key attribute give every key the same code. 
+uint64_t    dict_hash_key( const dict_t* dict, /* T key */... );            // return the hash code of `key`, the same one `dict` uses internally. 
+void*       dict_get_prehashed( dict_t* dict, uint64_t code, /* T key */... );      // same as `dict_get`, `code` must be the one `dict_hash_key` returns for `key` on a dict with the same key attribute. 
+void*       dict_find_prehashed( dict_t* dict, uint64_t code, /* T key */... );     // same as `dict_find`, with the code of `key`. 
+bool        dict_has_prehashed( const dict_t* dict, uint64_t code, /* T key */... );    // same as `dict_has`, with the code of `key`. 
+bool        dict_remove_prehashed( dict_t* dict, uint64_t code, /* T key */... );   // same as `dict_remove`, with the code of `key`. 
+
+// bulk merge, `dst` is resized once up front and the hash codes stored in `src` are reused. Both dicts need the same key attribute and val size, return false otherwise. 
+bool        dict_merge( dict_t* dst, const dict_t* src, dict_conflict_t policy, dict_combine combine, void* ctx );  // copy every pair of `src` into `dst`, keys are copied and vals are copied bytewise, so use `dict_merge_move` if vals own memory. 
+bool        dict_merge_move( dict_t* dst, dict_t* src, dict_conflict_t policy, dict_combine combine, void* ctx );   // move every pair of `src` into `dst`, leaving `src` empty. Nodes are taken over without copying when both dicts have the same options. Vals of `src` that are not kept are freed. 
+
+// parallel passes over every pair, the buckets are split into chunks that idle threads steal from busy ones. Pairs are visited in no particular order, the callbacks run on up to `nthreads` threads at once and must be thread safe. Return false if out of memory. 
+bool        dict_parallel_foreach( dict_t* dict, dict_each each, void* ctx, size_t nthreads );     // run `each` on every pair, vals modified by it are not logged. 
+bool        dict_parallel_reduce( const dict_t* dict, void* result, size_t size, dict_reduce reduce, dict_combine combine, void* ctx, size_t nthreads );    // every thread folds pairs into its own copy of the `size` bytes at `result`, which hold the identity of the reduction, then `combine` merges each copy into `result`. 
+
+// set algebra, meant for dicts used as sets with `val.size` 0. The keys of one dict are looked up in the other in batches, reusing the hash codes stored in the nodes. Both dicts need the same key attribute and val size, return false otherwise. 
+bool        dict_union( dict_t* dst, const dict_t* src );                   // insert the keys of `src` missing from `dst`, same as `dict_merge` with DICT_KEEP. 
+bool        dict_intersect( dict_t* dst, const dict_t* src );               // remove the keys of `dst` that are not in `src`. 
+bool        dict_difference( dict_t* dst, const dict_t* src );              // remove the keys of `dst` that are in `src`, walking whichever of both is smaller. 
+bool        dict_is_subset( const dict_t* sub, const dict_t* dict );        // return true if every key of `sub` is in `dict`. 
+
+// bulk removal in a single pass over the buckets, without looking any key up. Matching pairs are freed with `key.free` and `val.free` as they are found, then the buckets are shrunk once if most of them became empty. `pred` must not modify the dict. 
+size_t      dict_remove_if( dict_t* dict, dict_pred pred, void* ctx );      // remove every pair `pred` returns true for. Return the amount removed. 
+size_t      dict_retain( dict_t* dict, dict_pred pred, void* ctx );         // keep only the pairs `pred` returns true for. Return the amount removed. 
+
+// ordered queries, only available if `order.enable` was set. The keys inserted since the last query are sorted in first, then each query costs O(log n + k). 
+size_t      dict_range( dict_t* dict, dict_visit visit, void* ctx, /* T lo, T hi */... );  // visit the pairs with `lo <= key <= hi` in order. Return the amount of pairs visited. 
+size_t      dict_prefix( dict_t* dict, const char* prefix, dict_visit visit, void* ctx );   // visit the DICT_STR keys starting with `prefix` in order, `order.cmpr` must keep them next to each other. Return the amount of pairs visited. 
+
+// single writer mode, only available if `swmr.enable` was set. Every function above is called from the writer thread, insertions and updates go through `dict_set` so readers never see a val being written. 
+// Readers take no lock and write nothing shared, removed pairs are freed once every read section that began before the removal has ended. 
+dict_reader_t* dict_reader_join( dict_t* dict );                           // register a reader thread, return NULL if the dict is not in single writer mode. 
+void        dict_reader_leave( dict_reader_t* reader );                     // unregister a reader, every reader leaves before `dict_destroy`. 
+void        dict_read_begin( dict_reader_t* reader );                       // start a read section, pairs found inside it stay valid until it ends. 
+void        dict_read_end( dict_reader_t* reader );                         // end a read section, keep them short so memory can be reclaimed. 
+const void* dict_read_find( dict_reader_t* reader, /* T key */... );        // return the address of `val` to the corresponding `key`, or NULL. Only inside a read section. 
+bool        dict_read_has( dict_reader_t* reader, /* T key */... );         // return true if key is in the dict. Only inside a read section. 
+
+// aggregation mode, only available if `agg.enable` was set. Every thread folds its vals into a local table without any lock, remembering the nodes of its hottest keys, and hands the table over with `dict_agg_flush`. 
+// `dict_agg_merge` then moves the nodes of the tables handed over into the dict, reusing their hash codes. `alloc`, `key.copy`, `key.hash`, `key.cmpr` and `combine` must be thread safe. 
+dict_local_t* dict_agg_join( dict_t* dict );                            // create the local table of a thread, return NULL if the dict is not in aggregation mode. 
+bool        dict_agg_add( dict_local_t* local, const void* val, /* T key */... );  // fold `val` into the local val of `key`, a new key starts with a copy of `val`. Return false if out of memory. 
+bool        dict_agg_flush( dict_local_t* local );                      // hand the local table over to the dict and start an empty one. Return false if out of memory. 
+void        dict_agg_leave( dict_local_t* local );                      // flush and free the local table, every thread leaves before `dict_destroy`. 
+bool        dict_agg_merge( dict_t* dict );                             // fold every table handed over so far into the dict, called by the thread using the dict. Tables still pending at `dict_destroy` are dropped. 
+
+// background snapshot, encoded the same way as `dict_serialize`. The dict stays usable from the calling thread while the snapshot is running, buckets are copied right before they get modified. 
+// Vals must not be modified through addresses obtained before `dict_snapshot_begin`, resizing is put off until `dict_snapshot_end`, and `alloc` must be thread safe. 
+dict_snapshot_t* dict_snapshot_begin( dict_t* dict, dict_writer write, void* ctx );  // start a snapshot on a background thread. If `write` is provided, the data is streamed to it, otherwise it is kept in memory. Return NULL on failure. 
+bool        dict_snapshot_end( dict_snapshot_t* snapshot, void** data, size_t* bytes ); // wait for the snapshot to finish. Without `write`, `data` receives the encoded data allocated by `alloc`, nothing is kept if `data` is NULL. Must be called before `dict_destroy`. 
+
+// mutation log. Every insertion, modification and removal is appended to the log, a val modified through the address returned by `dict_get` is logged when the next call on the dict comes in. Not available if `key.copy` is provided. 
+bool        dict_log_open( dict_t* dict, const char* path, size_t batch );      // append the mutations to `path`. Records are written and synced to disk every `batch` bytes, 64KiB if 0. 
+bool        dict_log_sync( dict_t* dict );                                      // write and sync the pending records. 
+bool        dict_log_close( dict_t* dict );                                     // sync and stop logging, `dict_destroy` does this as well. 
+bool        dict_log_compact( dict_t* dict, const char* snapshot );             // write the dict to `snapshot` in the `dict_serialize` encoding and empty the log. 
+dict_t*     dict_recover( dict_args_t args, const char* snapshot, const char* log );    // rebuild a dict from the last compacted `snapshot` and the `log` written since, either may be NULL. 
+
+// expiry, only available if `ttl.enable` was set. An expired pair is gone for every lookup and is reclaimed by it, or by the timing wheel a few at a time on insertion and by `dict_expire_tick`, with `val.free` called as usual. 
+// Until then it is still counted by `dict_len` and seen by `dict_key`, `dict_serialize` and the other walks over every pair. Expiry times are not serialized nor logged. 
+// `dict_merge` and `dict_merge_move` give a key new to `dst` the time it had left in `src`, a key already in `dst` keeps its own expiry. 
+bool        dict_expire( dict_t* dict, uint64_t ttl, /* T key */... );      // make `key` expire `ttl` units of `ttl.now` from now. Return false if the key is not in the dict. 
+bool        dict_persist( dict_t* dict, /* T key */... );                   // make `key` never expire. Return false if the key is not in the dict. 
+uint64_t    dict_expiry( dict_t* dict, /* T key */... );                    // return the time `key` expires at, or 0 if it never does or is not in the dict. 
+size_t      dict_expire_tick( dict_t* dict, size_t budget );                // reclaim up to `budget` expired pairs, all of them if 0, without walking the buckets. Return the amount reclaimed. 
+
+// latency profiling, only available if built with DICT_PROFILE defined, e.g. `make PROFILE=1`. Without it every call on the dict costs the same as before, and with it but stopped a single branch. 
+bool        dict_profile_start( dict_t* dict, uint32_t sample );            // time one in `sample` operations, every one if 0, and every resize, starting from empty histograms. Return false if not built with DICT_PROFILE or out of memory. 
+void        dict_profile_stop( dict_t* dict );                              // stop timing and free the histograms, `dict_destroy` does this as well. 
+const dict_profile_t* dict_profile( const dict_t* dict );                   // return the histograms collected so far, or NULL if not profiling. Valid until `dict_profile_stop`. 
+bool        dict_profile_dump( const dict_t* dict, FILE* fp );              // write count, mean, percentiles and max of each operation and the latest resizes to `fp` as text. Return false if not profiling. 
+uint64_t    dict_profile_percentile( const dict_prof_hist_t* hist, double q );  // return the latency in nanoseconds below which a fraction `q` of the samples fall, within 1/8 of it. 
+uint64_t    dict_profile_bound( size_t bucket );                            // return the smallest latency in nanoseconds counted by `bucket`. 
+
+// string intern pool, shared by every dict created with it as `key.pool`. Each distinct key is stored once with its length and hash and counted by reference, keys of the same pool compare by address first. 
+// Calls on the pool take its lock, so dicts on different threads may share it as long as `alloc` is thread safe. A string from `dict_pool_intern` looked up with `dict_find_prehashed( dict, dict_pool_hash( str ), str )` is neither hashed nor compared character by character. 
+dict_pool_t* dict_pool_create( dict_alloc_t alloc );                        // create an empty pool, all zero `alloc` for libc malloc. Return NULL if out of memory. 
+void        dict_pool_destroy( dict_pool_t* pool );                         // free the pool and what is left in it, once no dict uses it anymore. 
+const char* dict_pool_intern( dict_pool_t* pool, const char* str );         // return the pooled copy of `str`, adding it if needed, and hold a reference to it. Return NULL if out of memory. 
+void        dict_pool_release( dict_pool_t* pool, const char* str );        // drop a reference taken by `dict_pool_intern`. 
+uint64_t    dict_pool_hash( const char* str );                              // return the hash of a pooled string, the one `dict_hash_key` gives on a DICT_STR dict without `key.hash`. 
+size_t      dict_pool_length( const char* str );                            // return the length of a pooled string. 
+size_t      dict_pool_len( dict_pool_t* pool );                             // return the amount of distinct strings in the pool. 
+
+
+// shared memory dict, a single copy in a region mapped by every process, links are stored as offsets so each process may map it anywhere. Not available on Windows. 
+// Calls hold a process shared lock, many readers or one writer. The region does not grow, `key.hash` and `key.cmpr` must give the same result in every process, and `key.copy` is not supported. A handle is used by one thread at a time. 
+dict_shm_t* dict_shm_create( const char* name, dict_key_attr_t key, size_t val_size, size_t bytes );   // create the region `name` of `bytes` bytes, for `shm_open`. If `name` is NULL, the region has no name and is only shared with processes forked afterwards. Return NULL on failure. 
+dict_shm_t* dict_shm_open( const char* name, dict_key_attr_t key );          // attach to a region created by `dict_shm_create`, `key` must be the one it was created with. Return NULL on failure. 
+void        dict_shm_close( dict_shm_t* shm );                              // detach from the region, the region itself stays until it is unlinked and closed by every process. 
+bool        dict_shm_unlink( const char* name );                            // remove the name of a region. 
+bool        dict_shm_set( dict_shm_t* shm, const void* val, /* T key */... );   // copy `val` into the val of `key`, inserting it if needed. Return false if the region is full. 
+bool        dict_shm_update( dict_shm_t* shm, dict_val_init update, void* ctx, /* T key */... );  // run `update` on the val of `key` under the write lock, inserting it zeroed if needed. Return false if the region is full. 
+bool        dict_shm_find( dict_shm_t* shm, void* val, /* T key */... );    // copy the val of `key` into `val` if not NULL. Return false if the key is not in the dict. 
+bool        dict_shm_remove( dict_shm_t* shm, /* T key */... );             // return true if the key was in the dict. 
+size_t      dict_shm_len( dict_shm_t* shm );                                // return the total amount of pairs in the region. 
+bool        dict_shm_load( dict_shm_t* shm, const dict_t* dict );           // copy every pair of `dict`, which needs the same key type and val size, e.g. straight after `dict_deserialize`. Return false if the region is full. 
 
 
 
-// dict_create_args( dict_key_attr_t key, dict_key_attr_t val, dict_alloc_t alloc )
-// .key = { .type, .size, .copy, .free, .hash, .cmpr }
-// .val = { .size, .free }
-// .alloc = { .malloc, .free }
+// dict_create_args( dict_key_attr_t key, dict_key_attr_t val, dict_alloc_t alloc, dict_dense_attr_t dense, dict_filter_attr_t filter, dict_cache_attr_t cache, dict_order_attr_t order, dict_swmr_attr_t swmr, dict_agg_attr_t agg, dict_ttl_attr_t ttl )
+// .key = { .type, .size, .copy, .free, .hash, .cmpr, .pool }
+// .val = { .size, .free, .split }
+// .alloc = { .malloc, .free } or { .ctx, .alloc, .dealloc, .realloc }
+// .dense = { .enable, .fill }
+// .filter = { .enable, .bits }
+// .cache = { .max_len, .max_bytes, .evict, .ctx }
+// .order = { .enable, .cmpr }
+// .swmr = { .enable, .batch }
+// .agg = { .enable, .op, .type, .combine, .ctx }
+// .ttl = { .enable, .now, .ctx, .budget }
 #define dict_create_args( ... )                     dict_create( (dict_args_t) { __VA_ARGS__ } )
 
 
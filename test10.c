@@ -0,0 +1,97 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <inttypes.h>
+
+#define dict_int64( dict, key ) ( *(int64_t*) dict_get( dict, key ) )
+
+// dict_writer
+bool write_file( const void* data, size_t bytes, void* ctx )
+{
+    return fwrite( data, 1, bytes, ctx ) == bytes;
+}
+
+int main( void )
+{
+    dict_args_t args = { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) } };
+    dict_t* dict = dict_create( args );
+
+    for ( int64_t i = 0; i < 20000; i++ )
+    {
+        dict_int64( dict, i ) = i;
+    }
+
+    // keep writing while both snapshots are taken in the background
+    FILE* fp = fopen( "test10.bin", "wb+" );
+    dict_snapshot_t* snap = dict_snapshot_begin( dict, write_file, fp );
+    for ( int64_t i = 0; i < 20000; i++ )
+    {
+        dict_int64( dict, i ) = -1;
+        dict_remove( dict, i + 1 );
+        dict_int64( dict, i + 100000 ) = i;
+    }
+    printf( "streamed: %d, ", dict_snapshot_end( snap, NULL, NULL ) );
+
+    void* data;
+    size_t bytes;
+    snap = dict_snapshot_begin( dict, NULL, NULL );
+    for ( int64_t i = 0; i < 20000; i++ )
+    {
+        dict_remove( dict, i + 100000 );
+    }
+    printf( "in memory: %d, live len: %zu\n", dict_snapshot_end( snap, &data, &bytes ), dict_len( dict ) );
+    dict_destroy( dict );
+
+    // the first snapshot holds the pairs from before the writes
+    fseek( fp, 0, SEEK_END );
+    size_t size = ftell( fp );
+    fseek( fp, 0, SEEK_SET );
+    void* file = malloc( size );
+    fread( file, size, 1, fp );
+    fclose( fp );
+    dict = dict_deserialize( args, file );
+    free( file );
+    int64_t sum = 0;
+    for ( int64_t i = 0; i < 20000; i++ )
+    {
+        sum += dict_int64( dict, i );
+    }
+    printf( "first: len %zu, sum %" PRId64 "\n", dict_len( dict ), sum );
+    dict_destroy( dict );
+
+    dict = dict_deserialize( args, data );
+    free( data );
+    printf( "second: len %zu, has 100000: %d\n", dict_len( dict ), dict_has( dict, (int64_t) 100000 ) );
+    dict_destroy( dict );
+
+    // a direct-indexed dict that turns hashed while the snapshot is running
+    dict_args_t dense = { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } };
+    dict = dict_create( dense );
+    for ( int64_t i = 0; i < 1000; i++ )
+    {
+        dict_int64( dict, i ) = i;
+    }
+    bool before = dict_stats( dict ).dense;
+    snap = dict_snapshot_begin( dict, NULL, NULL );
+    for ( int64_t i = 1; i <= 1000; i++ )
+    {
+        int64_t val = -i;
+        dict_set( dict, &val, i << 32 );
+    }
+    printf( "dense: %d then %d, snapshot: %d, live len: %zu\n", before, dict_stats( dict ).dense, dict_snapshot_end( snap, &data, &bytes ), dict_len( dict ) );
+    dict_destroy( dict );
+
+    dict = dict_deserialize( dense, data );
+    free( data );
+    printf( "dense snapshot: len %zu, 999 -> %" PRId64 ", has 1 << 32: %d\n", dict_len( dict ), dict_int64( dict, (int64_t) 999 ), dict_has( dict, (int64_t) 1 << 32 ) );
+    dict_destroy( dict );
+
+    // an in-memory snapshot nobody takes is dropped
+    dict = dict_create( args );
+    dict_int64( dict, (int64_t) 1 ) = 1;
+    snap = dict_snapshot_begin( dict, NULL, NULL );
+    dict_int64( dict, (int64_t) 2 ) = 2;
+    printf( "dropped: %d, live len: %zu\n", dict_snapshot_end( snap, NULL, NULL ), dict_len( dict ) );
+    dict_destroy( dict );
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+#define dict_int32( dict, key ) ( *(int32_t*) dict_get( dict, key ) )
+
+int main( void )
+{
+    dict_args_t args = { .key = { .type = DICT_STR }, .val = { .size = sizeof (int32_t) } };
+    remove( "test11.snap" );
+    remove( "test11.log" );
+
+    dict_t* dict = dict_create( args );
+    dict_log_open( dict, "test11.log", 0 );
+
+    dict_int32( dict, "alpha" ) = 1;
+    dict_int32( dict, "beta" )  = 2;
+    dict_int32( dict, "gamma" ) = 3;
+
+    // fold everything so far into a snapshot, the log starts over
+    dict_log_compact( dict, "test11.snap" );
+
+    dict_int32( dict, "beta" ) += 40;
+    dict_remove( dict, "alpha" );
+    dict_int32( dict, "delta" ) = 4;
+    dict_log_sync( dict );
+
+    dict_int32( dict, "epsilon" ) = 5;
+
+    // simulate a crash halfway through writing the record of epsilon
+    FILE* fp = fopen( "test11.log", "rb" );
+    fseek( fp, 0, SEEK_END );
+    long synced = ftell( fp );
+    fclose( fp );
+    dict_log_close( dict );
+    dict_destroy( dict );
+    fp = fopen( "test11.log", "rb+" );
+    char* data = malloc( synced + 3 );
+    fread( data, 1, synced + 3, fp );
+    fclose( fp );
+    fp = fopen( "test11.log", "wb" );
+    fwrite( data, 1, synced + 3, fp );
+    fclose( fp );
+    free( data );
+
+    dict = dict_recover( args, "test11.snap", "test11.log" );
+    const char* keys[] = { "alpha", "beta", "gamma", "delta", "epsilon" };
+    for ( size_t i = 0; i < sizeof keys / sizeof keys[0]; i++ )
+    {
+        int32_t* val = dict_find( dict, keys[i] );
+        printf( "%s: %d\n", keys[i], val != NULL ? *val : -1 );
+    }
+    dict_destroy( dict );
+
+    remove( "test11.snap" );
+    remove( "test11.log" );
+
+    return 0;
+}
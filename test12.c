@@ -0,0 +1,61 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+// dict_combine
+void add_count( void* dest, const void* src, void* ctx )
+{
+    (void) ctx;
+    *(size_t*) dest += *(const size_t*) src;
+}
+
+int main( void )
+{
+    const char* words[] = { "apple", "pear", "plum", "fig", "kiwi", "lime" };
+
+    // one rollup per hour, folded into a daily total
+    dict_t* day = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (size_t) } );
+    for ( size_t hour = 0; hour < 24; hour++ )
+    {
+        dict_t* rollup = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (size_t) } );
+        for ( size_t i = 0; i <= hour % 6; i++ )
+        {
+            *(size_t*) dict_get( rollup, words[i] ) += hour;
+        }
+        if ( hour % 2 == 0 )
+        {
+            dict_merge( day, rollup, DICT_COMBINE, add_count, NULL );
+        }
+        else
+        {
+            dict_merge_move( day, rollup, DICT_COMBINE, add_count, NULL );
+            if ( dict_len( rollup ) != 0 ) printf( "rollup not emptied\n" );
+        }
+        dict_destroy( rollup );
+    }
+    for ( size_t i = 0; i < sizeof words / sizeof words[0]; i++ )
+    {
+        printf( "%s: %zu\n", words[i], *(size_t*) dict_find( day, words[i] ) );
+    }
+
+    // conflict policies
+    dict_t* a = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    dict_t* b = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    for ( int64_t i = 0; i < 1000; i++ )
+    {
+        *(int64_t*) dict_get( a, i * 2 ) = 1;
+        *(int64_t*) dict_get( b, i * 3 ) = 2;
+    }
+    dict_merge( a, b, DICT_KEEP, NULL, NULL );
+    printf( "keep: len %zu, 6 -> %ld, 3 -> %ld\n", dict_len( a ), *(int64_t*) dict_find( a, (int64_t) 6 ), *(int64_t*) dict_find( a, (int64_t) 3 ) );
+    dict_merge_move( a, b, DICT_OVERWRITE, NULL, NULL );
+    printf( "overwrite: len %zu, 6 -> %ld, src len %zu\n", dict_len( a ), *(int64_t*) dict_find( a, (int64_t) 6 ), dict_len( b ) );
+
+    // mismatched dicts are refused
+    printf( "merge into itself: %d, mismatched: %d\n", dict_merge( a, a, DICT_KEEP, NULL, NULL ), dict_merge( a, day, DICT_KEEP, NULL, NULL ) );
+
+    dict_destroy( a );
+    dict_destroy( b );
+    dict_destroy( day );
+
+    return 0;
+}
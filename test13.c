@@ -0,0 +1,72 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+#define AMOUNT 200000
+
+// dict_combine
+void add_count( void* dest, const void* src, void* ctx )
+{
+    (void) ctx;
+    *(int64_t*) dest += *(const int64_t*) src;
+}
+
+int main( void )
+{
+    int64_t* keys = malloc( sizeof (int64_t) * AMOUNT );
+    int64_t* vals = malloc( sizeof (int64_t) * AMOUNT );
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        keys[i] = ( i * 7919 ) % ( AMOUNT / 2 ) * 1000003;  // every key twice
+        vals[i] = i;
+    }
+
+    // the first occurrence is kept, later ones overwrite or get combined
+    dict_conflict_t policies[] = { DICT_KEEP, DICT_OVERWRITE, DICT_COMBINE };
+    const char*     names[]    = { "keep", "overwrite", "combine" };
+    for ( size_t p = 0; p < 3; p++ )
+    {
+        dict_t* dict = dict_build( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) } }, keys, vals, AMOUNT, 4, policies[p], add_count, NULL );
+        int64_t sum = 0;
+        for ( int64_t i = 0; i < AMOUNT / 2; i++ )
+        {
+            sum += *(int64_t*) dict_find( dict, i * 1000003 );
+        }
+        printf( "%s: len %zu, sum %ld\n", names[p], dict_len( dict ), sum );
+        dict_destroy( dict );
+    }
+
+    // same content whatever the amount of threads
+    dict_t* one  = dict_build( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .filter = { .enable = true } }, keys, vals, AMOUNT, 1, DICT_OVERWRITE, NULL, NULL );
+    dict_t* many = dict_build( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .filter = { .enable = true } }, keys, vals, AMOUNT, 8, DICT_OVERWRITE, NULL, NULL );
+    size_t same = 0;
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        int64_t* a = dict_find( one, keys[i] );
+        int64_t* b = dict_find( many, keys[i] );
+        same += a != NULL && b != NULL && *a == *b;
+    }
+    printf( "same: %d, has missing: %d\n", same == AMOUNT, dict_has( many, (int64_t) 1 ) );
+    dict_destroy( one );
+    dict_destroy( many );
+
+    // dense keys end up direct-indexed
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        keys[i] = i - 1000;
+    }
+    dict_t* dense = dict_build( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } }, keys, NULL, AMOUNT, 4, DICT_KEEP, NULL, NULL );
+    printf( "dense: %d, len %zu, has -1000: %d\n", dict_stats( dense ).dense, dict_len( dense ), dict_has( dense, (int64_t) -1000 ) );
+    dict_destroy( dense );
+
+    // string keys are copied
+    const char* words[] = { "apple", "pear", "apple", "plum", "pear", "apple" };
+    int64_t     ones[]  = { 1, 1, 1, 1, 1, 1 };
+    dict_t* count = dict_build( (dict_args_t) { .key = { .type = DICT_STR }, .val = { .size = sizeof (int64_t) } }, words, ones, 6, 3, DICT_COMBINE, add_count, NULL );
+    printf( "apple: %ld, pear: %ld, plum: %ld\n", *(int64_t*) dict_find( count, "apple" ), *(int64_t*) dict_find( count, "pear" ), *(int64_t*) dict_find( count, "plum" ) );
+    dict_destroy( count );
+
+    free( keys );
+    free( vals );
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+#define AMOUNT 5000
+
+// dict_hash, every key collides
+uint64_t flood_hash( const void* ptr )
+{
+    (void) ptr;
+    return 42;
+}
+
+// dict_cmpr
+int str_cmpr( const void* ptr1, const void* ptr2 )
+{
+    return strcmp( *(char**) ptr1, *(char**) ptr2 ) != 0;
+}
+
+// dict_deep_copy, keys are passed by address
+void str_dup( void* dest, const void* src )
+{
+    *(char**) dest = strdup( *(char* const*) src );
+}
+
+// dict_desctructor
+void str_drop( void* ptr )
+{
+    free( *(char**) ptr );
+}
+
+int main( void )
+{
+    // strided keys, spread over the buckets by the mixer
+    dict_t* dict = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        *(int64_t*) dict_get( dict, i << 20 ) = i;
+    }
+    dict_stats_t stats = dict_stats( dict );
+    int64_t sum = 0;
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        sum += *(int64_t*) dict_find( dict, i << 20 );
+    }
+    printf( "strided: len %zu, longest %zu, bins %zu, sum %ld, has 1: %d\n", stats.len, stats.longest, stats.bins, sum, dict_has( dict, (int64_t) 1 ) );
+
+    // chains shrink back into plain lists
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        if ( i % 1000 != 0 ) dict_remove( dict, i << 20 );
+    }
+    stats = dict_stats( dict );
+    printf( "shrunk: len %zu, bins %zu, has 3000: %d\n", stats.len, stats.bins, dict_has( dict, (int64_t) 3000 << 20 ) );
+    dict_destroy( dict );
+
+    // same hash code for every key, the keys themselves order the bin
+    char buf[32];
+    dict_t* flood = dict_create_args( .key = { .type = DICT_STR, .hash = flood_hash }, .val = { .size = sizeof (int) } );
+    dict_t* slow  = dict_create_args( .key = { .type = DICT_STR, .hash = flood_hash, .cmpr = str_cmpr }, .val = { .size = sizeof (int) } );
+    for ( int i = 0; i < AMOUNT; i++ )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        *(int*) dict_get( flood, buf ) = i;
+        *(int*) dict_get( slow, buf ) = i;
+    }
+    size_t found = 0;
+    for ( int i = 0; i < AMOUNT; i += 2 )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        found += *(int*) dict_find( flood, buf ) == i;
+        found += *(int*) dict_find( slow, buf ) == i;
+        dict_remove( flood, buf );
+        dict_remove( slow, buf );
+    }
+    printf( "flooded: found %zu, len %zu %zu, has key1: %d %d, has key2: %d %d\n", found, dict_len( flood ), dict_len( slow ),
+            dict_has( flood, "key1" ), dict_has( slow, "key1" ), dict_has( flood, "key2" ), dict_has( slow, "key2" ) );
+    dict_destroy( flood );
+    dict_destroy( slow );
+
+    // copied strings are ordered in the bin by their content, not by their address
+    dict_t* copied = dict_create_args( .key = { .type = DICT_STR, .copy = str_dup, .free = str_drop, .hash = flood_hash }, .val = { .size = sizeof (int) } );
+    for ( int i = 0; i < 64; i++ )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        char* key = buf;
+        *(int*) dict_get( copied, &key ) = i;
+    }
+    found = 0;
+    for ( int i = 0; i < 64; i++ )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        char* key = strdup( buf );
+        found += dict_find( copied, &key ) != NULL && *(int*) dict_find( copied, &key ) == i;
+        *(int*) dict_get( copied, &key ) = -i;
+        free( key );
+    }
+    printf( "copied: found %zu, len %zu, bins %zu\n", found, dict_len( copied ), dict_stats( copied ).bins );
+    dict_destroy( copied );
+
+    return 0;
+}
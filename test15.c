@@ -0,0 +1,94 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT 200000
+
+typedef struct
+{
+    const char* name;
+    dict_type_t type;
+    void*       keys;
+} keyset_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main( void )
+{
+    int64_t* seq    = malloc( sizeof (int64_t) * AMOUNT );
+    int64_t* stride = malloc( sizeof (int64_t) * AMOUNT );
+    void**   ptr    = malloc( sizeof (void*) * AMOUNT );
+    double*  frac   = malloc( sizeof (double) * AMOUNT );
+    char*    pool   = malloc( (size_t) 64 * AMOUNT );
+    for ( size_t i = 0; i < AMOUNT; i++ )
+    {
+        seq[i]    = (int64_t) i;
+        stride[i] = (int64_t) i << 16;
+        ptr[i]    = pool + 64 * i;
+        frac[i]   = (double) i / AMOUNT;
+    }
+
+    keyset_t sets[] =
+    {
+        { "sequential",     DICT_I64,   seq     },
+        { "strided",        DICT_I64,   stride  },
+        { "aligned-ptr",    DICT_PTR,   ptr     },
+        { "fraction-f64",   DICT_F64,   frac    },
+    };
+
+    for ( size_t s = 0; s < sizeof sets / sizeof sets[0]; s++ )
+    {
+        dict_t* dict = dict_new( sets[s].type, 0, sizeof (int64_t) );
+
+        double start = now();
+        for ( size_t i = 0; i < AMOUNT; i++ )
+        {
+            switch ( sets[s].type )
+            {
+                case DICT_I64:  *(int64_t*) dict_get( dict, ( (int64_t*) sets[s].keys )[i] ) = 1;   break;
+                case DICT_PTR:  *(int64_t*) dict_get( dict, ( (void**) sets[s].keys )[i] ) = 1;     break;
+                default:        *(int64_t*) dict_get( dict, ( (double*) sets[s].keys )[i] ) = 1;    break;
+            }
+        }
+        double insert = now() - start;
+
+        int64_t found = 0;
+        start = now();
+        for ( size_t i = 0; i < AMOUNT; i++ )
+        {
+            switch ( sets[s].type )
+            {
+                case DICT_I64:  found += *(int64_t*) dict_find( dict, ( (int64_t*) sets[s].keys )[i] );  break;
+                case DICT_PTR:  found += *(int64_t*) dict_find( dict, ( (void**) sets[s].keys )[i] );    break;
+                default:        found += *(int64_t*) dict_find( dict, ( (double*) sets[s].keys )[i] );   break;
+            }
+        }
+        double lookup = now() - start;
+
+        dict_stats_t stats = dict_stats( dict );
+        printf( "%-12s len %zu, found %ld, buckets %zu, longest %zu, insert %.1f ns, lookup %.1f ns\n", sets[s].name, stats.len, found,
+                stats.buckets, stats.longest, insert * 1e9 / AMOUNT, lookup * 1e9 / AMOUNT );
+        dict_destroy( dict );
+    }
+
+    // -0.0 and 0.0 are the same key, and so are all NaNs
+    dict_t* dict = dict_new( DICT_F64, 0, sizeof (int64_t) );
+    *(int64_t*) dict_get( dict, 0.0 ) = 1;
+    *(int64_t*) dict_get( dict, -0.0 ) += 1;
+    *(int64_t*) dict_get( dict, 0.0 / 0.0 ) = 5;
+    printf( "zero: %ld, len %zu, has NaN: %d\n", *(int64_t*) dict_find( dict, 0.0 ), dict_len( dict ), dict_has( dict, -( 0.0 / 0.0 ) ) );
+    dict_destroy( dict );
+
+    free( seq );
+    free( stride );
+    free( ptr );
+    free( frac );
+    free( pool );
+
+    return 0;
+}
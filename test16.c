@@ -0,0 +1,88 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+// dict_visit
+bool print_str( const void* key, const void* val, void* ctx )
+{
+    (void) ctx;
+    printf( " %s=%d", *(char**) key, *(const int*) val );
+    return true;
+}
+
+// dict_visit
+bool sum_i64( const void* key, const void* val, void* ctx )
+{
+    (void) val;
+    *(int64_t*) ctx += *(const int64_t*) key;
+    return true;
+}
+
+// dict_visit, stops after the first 3 keys
+bool first_three( const void* key, const void* val, void* ctx )
+{
+    (void) val;
+    printf( " %ld", *(const int64_t*) key );
+    return ++*(int*) ctx < 3;
+}
+
+// dict_cmpr, descending
+int desc( const void* ptr1, const void* ptr2 )
+{
+    int64_t a = *(const int64_t*) ptr1;
+    int64_t b = *(const int64_t*) ptr2;
+    return ( a < b ) - ( a > b );
+}
+
+int main( void )
+{
+    dict_t* dict = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .order = { .enable = true } );
+    for ( int64_t i = -5000; i < 5000; i += 3 )
+    {
+        dict_get( dict, i );
+    }
+
+    // sum of the keys in [-100, 100] is 0 except for the stride offset
+    int64_t sum = 0;
+    size_t  count = dict_range( dict, sum_i64, &sum, (int64_t) -100, (int64_t) 100 );
+    printf( "range: %zu keys, sum %ld\n", count, sum );
+
+    // removed keys leave the index, new ones join at the next query
+    for ( int64_t i = -5000; i < 0; i += 3 )
+    {
+        dict_remove( dict, i );
+    }
+    dict_get( dict, (int64_t) -1 );
+    int seen = 0;
+    printf( "first three:" );
+    count = dict_range( dict, first_three, &seen, INT64_MIN, INT64_MAX );
+    printf( ", visited %zu, total %zu, empty range: %zu\n", count, dict_range( dict, NULL, NULL, INT64_MIN, INT64_MAX ), dict_range( dict, NULL, NULL, (int64_t) 10, (int64_t) 5 ) );
+    dict_destroy( dict );
+
+    // custom order
+    dict_t* rev = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .order = { .enable = true, .cmpr = desc } );
+    for ( int64_t i = 0; i < 10; i++ )
+    {
+        dict_get( rev, i );
+    }
+    seen = 0;
+    printf( "descending:" );
+    dict_range( rev, first_three, &seen, (int64_t) 7, (int64_t) 0 );
+    printf( "\n" );
+    dict_destroy( rev );
+
+    // prefix over string keys
+    dict_t* words = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (int) }, .order = { .enable = true } );
+    const char* list[] = { "car", "cart", "carbon", "cat", "dog", "ca", "care", "zebra", "cargo" };
+    for ( size_t i = 0; i < sizeof list / sizeof list[0]; i++ )
+    {
+        *(int*) dict_get( words, list[i] ) = (int) i;
+    }
+    printf( "prefix car:" );
+    count = dict_prefix( words, "car", print_str, NULL );
+    printf( " (%zu)\n", count );
+    dict_remove( words, "carbon" );
+    printf( "prefix car after remove: %zu, prefix x: %zu, all: %zu\n", dict_prefix( words, "car", NULL, NULL ), dict_prefix( words, "x", NULL, NULL ), dict_prefix( words, "", NULL, NULL ) );
+    dict_destroy( words );
+
+    return 0;
+}
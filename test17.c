@@ -0,0 +1,115 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+// size checked pool, every block remembers the size it was allocated with
+typedef struct
+{
+    size_t  live;       // bytes not released yet
+    size_t  blocks;     // blocks not released yet
+    size_t  wrong;      // releases with a size different from the allocation
+} pool_t;
+
+// dict_alloc
+void* pool_alloc( void* ctx, size_t size, size_t align )
+{
+    (void) align;
+    pool_t* pool = ctx;
+    size_t* block = malloc( sizeof (size_t) * 2 + size );
+    block[0] = size;
+    pool->live += size;
+    pool->blocks++;
+    return block + 2;
+}
+
+// dict_dealloc
+void pool_dealloc( void* ctx, void* ptr, size_t size )
+{
+    pool_t* pool = ctx;
+    size_t* block = (size_t*) ptr - 2;
+    pool->wrong += block[0] != size;
+    pool->live -= block[0];
+    pool->blocks--;
+    free( block );
+}
+
+// bump arena, released all at once
+typedef struct
+{
+    char*   data;
+    size_t  used;
+    size_t  cap;
+} arena_t;
+
+// dict_alloc
+void* arena_alloc( void* ctx, size_t size, size_t align )
+{
+    arena_t* arena = ctx;
+    size_t start = ( arena->used + align - 1 ) & ~( align - 1 );
+    if ( start + size > arena->cap ) return NULL;
+    arena->used = start + size;
+    return arena->data + start;
+}
+
+int main( void )
+{
+    pool_t pool = { 0 };
+    dict_t* dict = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (int) },
+                                     .alloc = { .ctx = &pool, .alloc = pool_alloc, .dealloc = pool_dealloc },
+                                     .filter = { .enable = true }, .order = { .enable = true } );
+    char buf[32];
+    for ( int i = 0; i < 5000; i++ )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        *(int*) dict_get( dict, buf ) = i;
+    }
+    for ( int i = 0; i < 5000; i += 3 )
+    {
+        snprintf( buf, sizeof buf, "key%d", i );
+        dict_remove( dict, buf );
+    }
+
+    size_t count;
+    const void* keys = dict_key( dict, &count );
+    pool_dealloc( &pool, (void*) keys, sizeof (char*) * count );
+    size_t bytes;
+    void* data = dict_serialize( dict, &bytes );
+    printf( "len: %zu, prefix key1: %zu, blocks in use: %d\n", dict_len( dict ), dict_prefix( dict, "key1", NULL, NULL ), pool.blocks > 0 );
+    dict_destroy( dict );
+
+    dict_t* copy = dict_deserialize( (dict_args_t) { .key = { .type = DICT_STR }, .val = { .size = sizeof (int) }, .alloc = { .ctx = &pool, .alloc = pool_alloc, .dealloc = pool_dealloc } }, data );
+    pool_dealloc( &pool, data, bytes );
+    printf( "copy len: %zu, key4: %d\n", dict_len( copy ), *(int*) dict_find( copy, "key4" ) );
+    dict_destroy( copy );
+    printf( "pool: %zu bytes, %zu blocks left, %zu wrong sizes\n", pool.live, pool.blocks, pool.wrong );
+
+    // nothing is released one by one, the whole region goes away at the end
+    arena_t arena = { .data = malloc( 1 << 22 ), .cap = 1 << 22 };
+    dict_t* temp = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .alloc = { .ctx = &arena, .alloc = arena_alloc } );
+    for ( int64_t i = 0; i < 10000; i++ )
+    {
+        *(int64_t*) dict_get( temp, i * 7 ) = i;
+    }
+    printf( "arena: len %zu, 700 -> %ld, used some: %d\n", dict_len( temp ), *(int64_t*) dict_find( temp, (int64_t) 700 ), arena.used > 0 );
+    dict_destroy( temp );
+    free( arena.data );
+
+    // readers sit on their own cache line, with libc and with a plain `malloc`
+    dict_t* libc  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .swmr = { .enable = true } );
+    dict_t* plain = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .swmr = { .enable = true }, .alloc = { .malloc = malloc, .free = free } );
+    bool aligned = true;
+    dict_reader_t* readers[8];
+    for ( int i = 0; i < 8; i++ )
+    {
+        readers[i] = dict_reader_join( i % 2 ? plain : libc );
+        aligned = aligned && (uintptr_t) readers[i] % 64 == 0;
+    }
+    for ( int i = 0; i < 8; i++ )
+    {
+        dict_reader_leave( readers[i] );
+    }
+    printf( "readers aligned: %d\n", aligned );
+    dict_destroy( libc );
+    dict_destroy( plain );
+
+    return 0;
+}
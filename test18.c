@@ -0,0 +1,87 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define WORKERS 4
+#define AMOUNT  10000
+
+// dict_val_init, run under the write lock of the region
+void add_one( const void* key, void* val, void* ctx )
+{
+    (void) key;
+    (void) ctx;
+    ++*(int64_t*) val;
+}
+
+int main( void )
+{
+    // built once, then shared by every worker instead of deserialized by each one
+    dict_t* dict = dict_new( DICT_STR, 0, sizeof (int64_t) );
+    char buf[32];
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        snprintf( buf, sizeof buf, "key%ld", i );
+        *(int64_t*) dict_get( dict, buf ) = i;
+    }
+    dict_key_attr_t key = { .type = DICT_STR };
+    dict_shm_t* shm = dict_shm_create( NULL, key, sizeof (int64_t), 1 << 22 );
+    bool loaded = dict_shm_load( shm, dict );
+    printf( "loaded: %d, len %zu\n", loaded, dict_shm_len( shm ) );
+    fflush( stdout );
+    dict_destroy( dict );
+
+    for ( int w = 0; w < WORKERS; w++ )
+    {
+        if ( fork() == 0 )
+        {
+            int64_t sum = 0, val;
+            for ( int64_t i = 0; i < AMOUNT; i++ )
+            {
+                snprintf( buf, sizeof buf, "key%ld", i );
+                if ( dict_shm_find( shm, &val, buf ) ) sum += val;
+                dict_shm_update( shm, add_one, NULL, "hits" );
+            }
+            snprintf( buf, sizeof buf, "worker%d", w );
+            dict_shm_set( shm, &sum, buf );
+            dict_shm_close( shm );
+            exit( 0 );
+        }
+    }
+    for ( int w = 0; w < WORKERS; w++ )
+    {
+        wait( NULL );
+    }
+
+    for ( int64_t i = 0; i < AMOUNT; i += 2 )
+    {
+        snprintf( buf, sizeof buf, "key%ld", i );
+        dict_shm_remove( shm, buf );
+    }
+    int64_t hits = 0, sum = 0;
+    dict_shm_find( shm, &hits, "hits" );
+    dict_shm_find( shm, &sum, "worker2" );
+    printf( "hits: %ld, sum seen by worker2: %ld, len %zu, has key7: %d\n", hits, sum, dict_shm_len( shm ), dict_shm_find( shm, NULL, "key7" ) );
+    dict_shm_close( shm );
+
+    // named region, opened again by key attribute
+    dict_key_attr_t i64 = { .type = DICT_I64 };
+    dict_shm_unlink( "/dict-test18" );
+    dict_shm_t* named = dict_shm_create( "/dict-test18", i64, sizeof (double), 1 << 16 );
+    size_t stored = 0;
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        double val = i * 0.5;
+        stored += dict_shm_set( named, &val, i );
+    }
+    dict_shm_t* other = dict_shm_open( "/dict-test18", i64 );
+    double val = 0;
+    dict_shm_find( other, &val, (int64_t) 100 );
+    printf( "named: stored %zu of %d before full, 100 -> %.1f, wrong key type: %d\n", stored, AMOUNT, val,
+            dict_shm_open( "/dict-test18", (dict_key_attr_t) { .type = DICT_STR } ) != NULL );
+    dict_shm_close( other );
+    dict_shm_close( named );
+    dict_shm_unlink( "/dict-test18" );
+
+    return 0;
+}
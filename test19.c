@@ -0,0 +1,88 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT 1000000
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// set of the multiples of `step` below `AMOUNT * step`, scattered by a multiplier
+static dict_t* multiples( int64_t step, size_t amount )
+{
+    dict_t* set = dict_new( DICT_I64, 0, 0 );
+    for ( size_t i = 0; i < amount; i++ )
+    {
+        dict_get( set, (int64_t) ( i * step * 2654435761LLU ) );
+    }
+    return set;
+}
+
+int main( void )
+{
+    dict_t* twos   = multiples( 2, AMOUNT );
+    dict_t* threes = multiples( 3, AMOUNT );
+
+    // the old way, every key of one set checked against the other and removed if missing
+    dict_t* copy  = multiples( 3, AMOUNT );
+    double  start = now();
+    size_t  count;
+    const int64_t* keys = dict_key( copy, &count );
+    for ( size_t i = 0; i < count; i++ )
+    {
+        if ( dict_has( twos, keys[i] ) == false ) dict_remove( copy, keys[i] );
+    }
+    free( (void*) keys );
+    double naive = now() - start;
+
+    start = now();
+    dict_intersect( threes, twos );
+    double batched = now() - start;
+    printf( "intersect: %zu, naive %zu, same: %d\n", dict_len( threes ), dict_len( copy ), dict_is_subset( copy, threes ) && dict_is_subset( threes, copy ) );
+    fprintf( stderr, "naive %.1f ms, batched %.1f ms\n", naive * 1e3, batched * 1e3 );
+    dict_destroy( copy );
+
+    // multiples of 6 are a subset of the multiples of 2, but not the other way around
+    printf( "subset: %d %d\n", dict_is_subset( threes, twos ), dict_is_subset( twos, threes ) );
+    dict_difference( twos, threes );
+    printf( "difference: %zu, has 6: %d, has 4: %d\n", dict_len( twos ), dict_has( twos, (int64_t) ( 6 * 2654435761LLU ) ), dict_has( twos, (int64_t) ( 4 * 2654435761LLU ) ) );
+    dict_union( twos, threes );
+    printf( "union: %zu, has 6: %d\n", dict_len( twos ), dict_has( twos, (int64_t) ( 6 * 2654435761LLU ) ) );
+    dict_destroy( twos );
+    dict_destroy( threes );
+
+    // direct-indexed and hashed sets mixed, with string keys
+    dict_t* dense  = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = 0 }, .dense = { .enable = true } );
+    dict_t* hashed = dict_new( DICT_I32, 0, 0 );
+    for ( int32_t i = 0; i < 1000; i++ )
+    {
+        dict_get( dense, i );
+        if ( i % 10 == 0 ) dict_get( hashed, i );
+    }
+    dict_get( hashed, (int32_t) 5000 );
+    dict_difference( dense, hashed );
+    printf( "dense difference: %zu, has 10: %d, has 11: %d\n", dict_len( dense ), dict_has( dense, (int32_t) 10 ), dict_has( dense, (int32_t) 11 ) );
+    dict_destroy( dense );
+    dict_destroy( hashed );
+
+    dict_t* a = dict_new( DICT_STR, 0, 0 );
+    dict_t* b = dict_new( DICT_STR, 0, 0 );
+    const char* fruits[] = { "apple", "pear", "plum", "fig" };
+    for ( size_t i = 0; i < 4; i++ )
+    {
+        dict_get( a, fruits[i] );
+        if ( i % 2 == 0 ) dict_get( b, fruits[i] );
+    }
+    dict_t* nums = multiples( 1, 10 );
+    dict_intersect( a, b );
+    printf( "strings: %zu, has plum: %d, has pear: %d, mismatched: %d\n", dict_len( a ), dict_has( a, "plum" ), dict_has( a, "pear" ), dict_intersect( a, nums ) );
+    dict_destroy( a );
+    dict_destroy( b );
+    dict_destroy( nums );
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT  100000
+#define TABLES  3
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main( void )
+{
+    // long keys, so hashing is most of a lookup
+    char** keys = malloc( sizeof (char*) * AMOUNT );
+    for ( size_t i = 0; i < AMOUNT; i++ )
+    {
+        keys[i] = malloc( 128 );
+        snprintf( keys[i], 128, "customer/region-%04zu/segment-%03zu/account-%012zu/profile", i % 97, i % 13, i );
+    }
+
+    dict_t* tables[ TABLES ];
+    for ( size_t t = 0; t < TABLES; t++ )
+    {
+        tables[t] = dict_new( DICT_STR, 0, sizeof (int) );
+        for ( size_t i = t; i < AMOUNT; i += t + 1 )
+        {
+            *(int*) dict_get( tables[t], keys[i] ) = (int) t;
+        }
+    }
+
+    // join every key against all the tables
+    double start = now();
+    size_t plain = 0;
+    for ( size_t i = 0; i < AMOUNT; i++ )
+    {
+        for ( size_t t = 0; t < TABLES; t++ )
+        {
+            plain += dict_has( tables[t], keys[i] );
+        }
+    }
+    double slow = now() - start;
+
+    start = now();
+    size_t once = 0;
+    for ( size_t i = 0; i < AMOUNT; i++ )
+    {
+        uint64_t code = dict_hash_key( tables[0], keys[i] );
+        for ( size_t t = 0; t < TABLES; t++ )
+        {
+            once += dict_has_prehashed( tables[t], code, keys[i] );
+        }
+    }
+    double fast = now() - start;
+    printf( "joined: %zu, same: %d\n", once, once == plain );
+    fprintf( stderr, "hash per table %.1f ms, hash once %.1f ms\n", slow * 1e3, fast * 1e3 );
+
+    // every call that takes a key has a prehashed form
+    uint64_t code = dict_hash_key( tables[1], keys[1] );
+    int*  val     = dict_find_prehashed( tables[1], code, keys[1] );
+    bool  removed = dict_remove_prehashed( tables[1], code, keys[1] );
+    printf( "found: %d, removed: %d, has: %d\n", val != NULL, removed, dict_has( tables[1], keys[1] ) );
+    *(int*) dict_get_prehashed( tables[1], code, keys[1] ) = 7;
+    printf( "inserted again: %d, len %zu\n", *(int*) dict_find( tables[1], keys[1] ), dict_len( tables[1] ) );
+
+    // direct-indexed dicts accept the code and ignore it
+    dict_t* dense = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int) }, .dense = { .enable = true } );
+    *(int*) dict_get_prehashed( dense, dict_hash_key( dense, (int64_t) 5 ), (int64_t) 5 ) = 5;
+    printf( "dense: %d\n", dict_has_prehashed( dense, dict_hash_key( dense, (int64_t) 5 ), (int64_t) 5 ) );
+    dict_destroy( dense );
+
+    for ( size_t t = 0; t < TABLES; t++ )
+    {
+        dict_destroy( tables[t] );
+    }
+    for ( size_t i = 0; i < AMOUNT; i++ )
+    {
+        free( keys[i] );
+    }
+    free( keys );
+
+    return 0;
+}
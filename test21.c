@@ -0,0 +1,154 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define KEYS        4096
+#define READERS     4
+#define UPDATES     100000
+
+typedef struct
+{
+    int64_t key;
+    int64_t gen;
+    int64_t sum;    // key + gen, a torn val would not add up
+} route_t;
+
+typedef struct
+{
+    dict_t*         dict;
+    atomic_bool*    stop;
+    size_t          lookups;
+    size_t          found;
+    size_t          torn;
+} reader_arg_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void* reader( void* arg )
+{
+    reader_arg_t*  self   = arg;
+    dict_reader_t* reader = dict_reader_join( self->dict );
+    uint64_t       state  = (uintptr_t) arg;
+    while ( atomic_load( self->stop ) == false )
+    {
+        dict_read_begin( reader );
+        for ( int i = 0; i < 64; i++ )
+        {
+            state = state * 6364136223846793005LLU + 1442695040888963407LLU;
+            int64_t key = (int64_t) ( ( state >> 33 ) % ( KEYS * 2 ) );
+            const route_t* route = dict_read_find( reader, key );
+            if ( route != NULL )
+            {
+                self->found++;
+                self->torn += route->key != key || route->sum != route->key + route->gen;
+            }
+            self->lookups++;
+        }
+        dict_read_end( reader );
+    }
+    dict_reader_leave( reader );
+    return NULL;
+}
+
+// dict_pred
+bool far( const void* key, const void* val, void* ctx )
+{
+    (void) val;
+    (void) ctx;
+    return *(const int64_t*) key >= 8;
+}
+
+static void start_readers( pthread_t* threads, reader_arg_t* args, dict_t* dict, atomic_bool* stop )
+{
+    atomic_store( stop, false );
+    for ( int r = 0; r < READERS; r++ )
+    {
+        args[r] = (reader_arg_t) { .dict = dict, .stop = stop };
+        pthread_create( &threads[r], NULL, reader, &args[r] );
+    }
+}
+
+int main( void )
+{
+    dict_t* dict = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (route_t) }, .swmr = { .enable = true } );
+    for ( int64_t i = 0; i < KEYS; i++ )
+    {
+        route_t route = { i, 0, i };
+        dict_set( dict, &route, i );
+    }
+
+    atomic_bool  stop = false;
+    pthread_t    threads[ READERS ];
+    reader_arg_t args[ READERS ] = { 0 };
+    start_readers( threads, args, dict, &stop );
+
+    // the writer replaces routes, removes some and adds new keys, which also grows the buckets under the readers
+    double start = now();
+    for ( int64_t gen = 1; gen <= UPDATES; gen++ )
+    {
+        int64_t key   = ( gen * 7919 ) % ( KEYS * 2 );
+        route_t route = { key, gen, key + gen };
+        if ( gen % 5 == 0 ) dict_remove( dict, key );
+        else dict_set( dict, &route, key );
+    }
+    atomic_store( &stop, true );
+    size_t lookups = 0, found = 0, torn = 0;
+    for ( int r = 0; r < READERS; r++ )
+    {
+        pthread_join( threads[r], NULL );
+        lookups += args[r].lookups;
+        found   += args[r].found;
+        torn    += args[r].torn;
+    }
+    double elapsed = now() - start;
+    printf( "readers: %d, some found: %d, torn: %zu, len below %d: %d\n", READERS, found > 0, torn, KEYS * 2, dict_len( dict ) <= KEYS * 2 );
+    fprintf( stderr, "%.1f M lookups/s\n", lookups / elapsed / 1e6 );
+
+    // emptied in bulk under the readers, the buckets are kept as they are
+    size_t buckets = dict_stats( dict ).buckets;
+    start_readers( threads, args, dict, &stop );
+    for ( int round = 0; round < 100; round++ )
+    {
+        for ( int64_t i = 0; i < KEYS; i++ )
+        {
+            route_t route = { i, round, i + round };
+            dict_set( dict, &route, i );
+        }
+        dict_remove_if( dict, far, NULL );
+    }
+    atomic_store( &stop, true );
+    torn = 0;
+    for ( int r = 0; r < READERS; r++ )
+    {
+        pthread_join( threads[r], NULL );
+        torn += args[r].torn;
+    }
+    printf( "emptied: len %zu, torn: %zu, buckets kept: %d\n", dict_len( dict ), torn, dict_stats( dict ).buckets == buckets );
+
+    // the writer side is a regular dict
+    route_t last = { 42, UPDATES + 1, 42 + UPDATES + 1 };
+    dict_set( dict, &last, (int64_t) 42 );
+    dict_reader_t* late = dict_reader_join( dict );
+    dict_read_begin( late );
+    const route_t* route = dict_read_find( late, (int64_t) 42 );
+    printf( "42: gen %ld, writer agrees: %d, has -1: %d\n", route->gen, route->gen == ( (route_t*) dict_find( dict, (int64_t) 42 ) )->gen, dict_read_has( late, (int64_t) -1 ) );
+    dict_read_end( late );
+    dict_reader_leave( late );
+    dict_destroy( dict );
+
+    dict_t* plain = dict_new( DICT_I64, 0, sizeof (int) );
+    int  val   = 3;
+    bool fresh = dict_set( plain, &val, (int64_t) 1 );
+    bool again = dict_set( plain, &val, (int64_t) 1 );
+    printf( "not single writer: %d, set new: %d, set again: %d\n", dict_reader_join( plain ) != NULL, fresh, again );
+    dict_destroy( plain );
+
+    return 0;
+}
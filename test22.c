@@ -0,0 +1,98 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT  1000000
+#define THREADS 4
+
+typedef struct
+{
+    int64_t sum;
+    int64_t max;
+    size_t  count;
+} stats_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// dict_each
+void triple( const void* key, void* val, void* ctx )
+{
+    (void) key;
+    (void) ctx;
+    *(int64_t*) val *= 3;
+}
+
+// dict_reduce
+void gather( void* acc, const void* key, const void* val, void* ctx )
+{
+    (void) key;
+    (void) ctx;
+    stats_t* stats = acc;
+    int64_t  v     = *(const int64_t*) val;
+    stats->sum += v;
+    stats->max  = v > stats->max ? v : stats->max;
+    stats->count++;
+}
+
+// dict_combine
+void merge( void* dest, const void* src, void* ctx )
+{
+    (void) ctx;
+    stats_t*       a = dest;
+    const stats_t* b = src;
+    a->sum  += b->sum;
+    a->max   = b->max > a->max ? b->max : a->max;
+    a->count += b->count;
+}
+
+int main( void )
+{
+    dict_t* dict = dict_new( DICT_STR, 0, sizeof (int64_t) );
+    char buf[32];
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        snprintf( buf, sizeof buf, "user:%ld", i );
+        *(int64_t*) dict_get( dict, buf ) = i;
+    }
+
+    double start = now();
+    dict_parallel_foreach( dict, triple, NULL, THREADS );
+    stats_t stats = { 0, INT64_MIN, 0 };
+    dict_parallel_reduce( dict, &stats, sizeof stats, gather, merge, NULL, THREADS );
+    fprintf( stderr, "foreach and reduce: %.1f ms\n", ( now() - start ) * 1e3 );
+    printf( "count %zu, sum %ld, max %ld, user:7 -> %ld\n", stats.count, stats.sum, stats.max, *(int64_t*) dict_find( dict, "user:7" ) );
+
+    // one thread gives the same result
+    stats_t serial = { 0, INT64_MIN, 0 };
+    dict_parallel_reduce( dict, &serial, sizeof serial, gather, merge, NULL, 1 );
+    printf( "serial same: %d\n", serial.sum == stats.sum && serial.max == stats.max && serial.count == stats.count );
+
+    start = now();
+    dict_destroy_parallel( dict, THREADS );
+    fprintf( stderr, "parallel destroy: %.1f ms\n", ( now() - start ) * 1e3 );
+
+    // direct-indexed pairs are split by slot
+    dict_t* dense = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } );
+    for ( int32_t i = 0; i < 1000; i += 2 )
+    {
+        *(int64_t*) dict_get( dense, i ) = i;
+    }
+    dict_parallel_foreach( dense, triple, NULL, THREADS );
+    stats = (stats_t) { 0, INT64_MIN, 0 };
+    dict_parallel_reduce( dense, &stats, sizeof stats, gather, merge, NULL, THREADS );
+    printf( "dense: %d, count %zu, sum %ld, max %ld\n", dict_stats( dense ).dense, stats.count, stats.sum, stats.max );
+    dict_destroy_parallel( dense, THREADS );
+
+    // nothing to visit
+    dict_t* empty = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    stats = (stats_t) { 0, INT64_MIN, 0 };
+    printf( "empty: %d, count %zu\n", dict_parallel_reduce( empty, &stats, sizeof stats, gather, merge, NULL, THREADS ), stats.count );
+    dict_destroy_parallel( empty, THREADS );
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define THREADS 4
+#define EVENTS  500000
+#define KEYS    100000
+
+typedef struct
+{
+    dict_t*         dict;
+    pthread_mutex_t* lock;
+    uint64_t        seed;
+} worker_arg_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// skewed keys, a few of them make up most of the events
+static int64_t next_key( uint64_t* state )
+{
+    *state = *state * 6364136223846793005LLU + 1442695040888963407LLU;
+    uint64_t r = *state >> 33;
+    return r % 4 != 0 ? (int64_t) ( r % 16 ) : (int64_t) ( r % KEYS );
+}
+
+void* count_locked( void* arg )
+{
+    worker_arg_t* self  = arg;
+    uint64_t      state = self->seed;
+    for ( size_t i = 0; i < EVENTS; i++ )
+    {
+        int64_t key = next_key( &state );
+        pthread_mutex_lock( self->lock );
+        ( *(uint64_t*) dict_get( self->dict, key ) )++;
+        pthread_mutex_unlock( self->lock );
+    }
+    return NULL;
+}
+
+void* count_local( void* arg )
+{
+    worker_arg_t* self  = arg;
+    uint64_t      state = self->seed;
+    uint64_t      one   = 1;
+    dict_local_t* local = dict_agg_join( self->dict );
+    for ( size_t i = 0; i < EVENTS; i++ )
+    {
+        dict_agg_add( local, &one, next_key( &state ) );
+        if ( i % 100000 == 99999 ) dict_agg_flush( local );
+    }
+    dict_agg_leave( local );
+    return NULL;
+}
+
+// dict_combine, keeps the earliest and latest timestamp of a key
+typedef struct
+{
+    double first;
+    double last;
+} span_t;
+
+void widen( void* dest, const void* src, void* ctx )
+{
+    (void) ctx;
+    span_t*       a = dest;
+    const span_t* b = src;
+    a->first = b->first < a->first ? b->first : a->first;
+    a->last  = b->last  > a->last  ? b->last  : a->last;
+}
+
+int main( void )
+{
+    pthread_t       threads[ THREADS ];
+    worker_arg_t    args[ THREADS ];
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    dict_t* locked = dict_new( DICT_I64, 0, sizeof (uint64_t) );
+    double  start  = now();
+    for ( int t = 0; t < THREADS; t++ )
+    {
+        args[t] = (worker_arg_t) { .dict = locked, .lock = &lock, .seed = t + 1 };
+        pthread_create( &threads[t], NULL, count_locked, &args[t] );
+    }
+    for ( int t = 0; t < THREADS; t++ )
+    {
+        pthread_join( threads[t], NULL );
+    }
+    double slow = now() - start;
+
+    dict_t* counts = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (uint64_t) }, .agg = { .enable = true, .op = DICT_AGG_SUM, .type = DICT_U64 } );
+    start = now();
+    for ( int t = 0; t < THREADS; t++ )
+    {
+        args[t] = (worker_arg_t) { .dict = counts, .seed = t + 1 };
+        pthread_create( &threads[t], NULL, count_local, &args[t] );
+    }
+    for ( int t = 0; t < THREADS; t++ )
+    {
+        pthread_join( threads[t], NULL );
+    }
+    dict_agg_merge( counts );
+    double fast = now() - start;
+    fprintf( stderr, "locked dict_get %.1f ms, local tables %.1f ms\n", slow * 1e3, fast * 1e3 );
+
+    size_t   len;
+    uint64_t total = 0;
+    bool     same  = dict_len( counts ) == dict_len( locked );
+    const int64_t* keys = dict_key( counts, &len );
+    for ( size_t i = 0; i < len; i++ )
+    {
+        uint64_t n = *(uint64_t*) dict_find( counts, keys[i] );
+        total += n;
+        same   = same && n == *(uint64_t*) dict_find( locked, keys[i] );
+    }
+    free( (void*) keys );
+    printf( "keys: %zu, events: %lu, same as locked: %d\n", dict_len( counts ), total, same );
+    dict_destroy( locked );
+    dict_destroy( counts );
+
+    // built-in max on doubles, single thread
+    dict_t* peaks = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (double) }, .agg = { .enable = true, .op = DICT_AGG_MAX, .type = DICT_F64 } );
+    dict_local_t* local = dict_agg_join( peaks );
+    double temps[] = { 12.5, 17.0, 9.25, 16.0 };
+    for ( size_t i = 0; i < 4; i++ )
+    {
+        dict_agg_add( local, &temps[i], "oslo" );
+        dict_agg_add( local, &(double) { temps[i] * 2 }, "rome" );
+    }
+    dict_agg_flush( local );
+    dict_agg_add( local, &(double) { 20.0 }, "oslo" );
+    dict_agg_leave( local );
+    dict_agg_merge( peaks );
+    dict_t* plain = dict_new( DICT_I32, 0, 0 );
+    printf( "oslo: %.2f, rome: %.2f, plain dict: %d\n", *(double*) dict_find( peaks, "oslo" ), *(double*) dict_find( peaks, "rome" ), dict_agg_join( plain ) != NULL );
+    dict_destroy( plain );
+    dict_destroy( peaks );
+
+    // user callback on a struct val
+    dict_t* spans = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = sizeof (span_t) }, .agg = { .enable = true, .op = DICT_AGG_CALL, .combine = widen } );
+    local = dict_agg_join( spans );
+    for ( int i = 0; i < 100; i++ )
+    {
+        dict_agg_add( local, &(span_t) { i, i }, i % 3 );
+        if ( i == 50 ) dict_agg_flush( local );
+    }
+    dict_agg_leave( local );
+    dict_agg_merge( spans );
+    span_t* span = dict_find( spans, 1 );
+    printf( "key 1: first %.0f, last %.0f, len %zu\n", span->first, span->last, dict_len( spans ) );
+    dict_destroy( spans );
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+#define SESSIONS 100000
+
+static size_t freed = 0;
+
+// dict_now, a clock moved by hand
+uint64_t manual( void* ctx )
+{
+    return *(uint64_t*) ctx;
+}
+
+// dict_desctructor
+void drop_token( void* ptr )
+{
+    free( *(char**) ptr );
+    freed++;
+}
+
+int main( void )
+{
+    uint64_t clock = 1000;
+    dict_t*  dict  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (char*), .free = drop_token },
+                                       .ttl = { .enable = true, .now = manual, .ctx = &clock } );
+    uint64_t state = 1;
+    uint64_t* deadlines = calloc( SESSIONS, sizeof (uint64_t) );
+    for ( int64_t i = 0; i < SESSIONS; i++ )
+    {
+        *(char**) dict_get( dict, i ) = strdup( "token" );
+        state = state * 6364136223846793005LLU + 1442695040888963407LLU;
+        if ( i % 10 == 0 ) continue;   // never expires
+        uint64_t ttl = ( state >> 33 ) % 100000;
+        dict_expire( dict, ttl, i );
+        deadlines[i] = clock + ttl;
+    }
+
+    // lookups hide expired pairs before anything is reclaimed
+    clock += 50000;
+    size_t alive = 0, hidden = 0;
+    for ( int64_t i = 0; i < SESSIONS; i++ )
+    {
+        bool live = deadlines[i] == 0 || deadlines[i] > clock;
+        alive  += live;
+        hidden += dict_find( dict, i ) == NULL && live == false;
+    }
+    printf( "alive: %zu, hidden: %d, len: %zu, freed: %d\n", alive, hidden == SESSIONS - alive, dict_len( dict ), freed == hidden );
+
+    // the rest is reclaimed by the wheel, a few at a time
+    clock += 50000;
+    size_t first = dict_expire_tick( dict, 100 );
+    size_t rest  = dict_expire_tick( dict, 0 );
+    printf( "tick: %zu then %zu, len: %zu, never expiring: %d, freed all: %d\n", first, rest, dict_len( dict ), dict_len( dict ) == SESSIONS / 10, freed == SESSIONS - SESSIONS / 10 );
+    free( deadlines );
+
+    // renewing, persisting and far away deadlines
+    *(char**) dict_get( dict, (int64_t) -1 ) = strdup( "renewed" );
+    *(char**) dict_get( dict, (int64_t) -2 ) = strdup( "persisted" );
+    *(char**) dict_get( dict, (int64_t) -3 ) = strdup( "far" );
+    dict_expire( dict, 10, (int64_t) -1 );
+    dict_expire( dict, 10, (int64_t) -2 );
+    dict_expire( dict, 1LLU << 40, (int64_t) -3 );
+    clock += 5;
+    dict_expire( dict, 10, (int64_t) -1 );
+    dict_persist( dict, (int64_t) -2 );
+    clock += 7;
+    size_t reclaimed = dict_expire_tick( dict, 0 );
+    printf( "renewed: %d, expiry %lu, persisted: %d, no expiry: %d, missing: %d\n", reclaimed == 0, dict_expiry( dict, (int64_t) -1 ) - clock,
+            dict_has( dict, (int64_t) -2 ), dict_expiry( dict, (int64_t) -2 ) == 0, dict_expire( dict, 1, (int64_t) -4 ) );
+    clock += 1LLU << 39;
+    bool far_alive = dict_has( dict, (int64_t) -3 );
+    clock += 1LLU << 39;
+    reclaimed = dict_expire_tick( dict, 0 );
+    printf( "far: %d, then reclaimed: %zu, has: %d\n", far_alive, reclaimed, dict_has( dict, (int64_t) -3 ) );
+
+    // a const query hides an expired pair without reclaiming it, the next lookup does
+    *(char**) dict_get( dict, (int64_t) -5 ) = strdup( "quiet" );
+    dict_expire( dict, 1, (int64_t) -5 );
+    clock += 2;
+    size_t len    = dict_len( dict );
+    size_t prior  = freed;
+    bool   has    = dict_has( dict, (int64_t) -5 );
+    bool   kept   = dict_len( dict ) == len && freed == prior;
+    bool   found  = dict_find( dict, (int64_t) -5 ) != NULL;
+    printf( "has expired: %d, kept: %d, found: %d, reclaimed by find: %d\n", has, kept, found, freed == prior + 1 && dict_len( dict ) == len - 1 );
+
+    // insertions reclaim a bounded amount on their own
+    for ( int64_t i = 0; i < 1000; i++ )
+    {
+        *(char**) dict_get( dict, SESSIONS + i ) = strdup( "short" );
+        dict_expire( dict, 1, SESSIONS + i );
+    }
+    clock += 2;
+    size_t before = dict_len( dict );
+    *(char**) dict_get( dict, (int64_t) -5 ) = strdup( "new" );
+    printf( "one insertion reclaimed %zu\n", before + 1 - dict_len( dict ) );
+    dict_destroy( dict );
+
+    // merged pairs keep the time they had left, on the same clock and on another one
+    uint64_t other = 5;
+    dict_t*  from  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .ttl = { .enable = true, .now = manual, .ctx = &clock } );
+    dict_t*  into  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .ttl = { .enable = true, .now = manual, .ctx = &clock } );
+    dict_t*  apart = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .ttl = { .enable = true, .now = manual, .ctx = &clock }, .filter = { .enable = true } );
+    dict_t*  away  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .ttl = { .enable = true, .now = manual, .ctx = &other } );
+    for ( int64_t i = 0; i < 100; i++ )
+    {
+        *(int64_t*) dict_get( from, i ) = i;
+        if ( i % 2 ) dict_expire( from, 10 + i, i );
+    }
+    uint64_t at = dict_expiry( from, (int64_t) 7 );
+    dict_merge( away, from, DICT_KEEP, NULL, NULL );
+    dict_merge_move( into, from, DICT_KEEP, NULL, NULL );
+    bool relinked = dict_expiry( into, (int64_t) 7 ) == at;
+    dict_merge_move( apart, into, DICT_KEEP, NULL, NULL );
+    printf( "moved: %d then %d, 8 never: %d, copied: 7 in %lu\n", relinked, dict_expiry( apart, (int64_t) 7 ) == at, dict_expiry( apart, (int64_t) 8 ) == 0, dict_expiry( away, (int64_t) 7 ) - other );
+    clock += 60;
+    other += 60;
+    size_t moved = 0, copied = 0;
+    for ( int64_t i = 0; i < 100; i++ )
+    {
+        moved  += dict_find( apart, i ) != NULL;
+        copied += dict_find( away, i ) != NULL;
+    }
+    printf( "after 60: moved %zu, copied %zu\n", moved, copied );
+    dict_destroy( from );
+    dict_destroy( into );
+    dict_destroy( apart );
+    dict_destroy( away );
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT 200000
+
+typedef struct
+{
+    int64_t id;
+    char    name[ 56 ];
+    double  scores[ 32 ];     // cold, only read once a profile is found
+} profile_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// build and probe a dict, half of the lookups miss
+static dict_t* run( bool split, double* elapsed )
+{
+    double  start = now();
+    dict_t* dict  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (profile_t), .split = split } );
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        profile_t* p = dict_get( dict, i * 2 );
+        p->id = i * 2;
+        snprintf( p->name, sizeof p->name, "user%ld", i );
+    }
+    size_t found = 0;
+    for ( int round = 0; round < 5; round++ )
+    {
+        for ( int64_t i = 0; i < AMOUNT * 2; i++ )
+        {
+            found += dict_has( dict, i * 7919 % ( AMOUNT * 2 ) );
+        }
+    }
+    *elapsed = now() - start;
+    printf( "split: %d, found %zu\n", split, found );
+    return dict;
+}
+
+int main( void )
+{
+    double  inline_time, split_time;
+    dict_t* plain = run( false, &inline_time );
+    dict_t* split = run( true, &split_time );
+    fprintf( stderr, "inline %.1f ms, split %.1f ms\n", inline_time * 1e3, split_time * 1e3 );
+
+    // vals keep their address while other pairs come and go
+    profile_t* kept = dict_find( split, (int64_t) 42 );
+    for ( int64_t i = 1; i < AMOUNT * 2; i += 2 )
+    {
+        dict_get( split, i );
+    }
+    for ( int64_t i = 1; i < AMOUNT * 2; i += 4 )
+    {
+        dict_remove( split, i );
+    }
+    printf( "stable: %d, name: %s, len: %zu\n", kept == dict_find( split, (int64_t) 42 ), kept->name, dict_len( split ) );
+
+    // the vals are written as one block, and read back into either layout
+    size_t bytes;
+    void*  data = dict_serialize( split, &bytes );
+    dict_t* back  = dict_deserialize( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (profile_t) } }, data );
+    dict_t* again = dict_deserialize( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (profile_t), .split = true } }, data );
+    free( data );
+    profile_t* a = dict_find( back, (int64_t) 1000 );
+    profile_t* b = dict_find( again, (int64_t) 1000 );
+    printf( "inline: %zu %s, split: %zu %s, odd: %ld\n", dict_len( back ), a->name, dict_len( again ), b->name, ( (profile_t*) dict_find( again, (int64_t) 3 ) )->id );
+    dict_destroy( back );
+    dict_destroy( again );
+
+    // string keys
+    dict_t* words = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (profile_t), .split = true } );
+    ( (profile_t*) dict_get( words, "alpha" ) )->id = 1;
+    ( (profile_t*) dict_get( words, "beta" ) )->id = 2;
+    dict_remove( words, "alpha" );
+    ( (profile_t*) dict_get( words, "gamma" ) )->id = 3;
+    data = dict_serialize( words, &bytes );
+    dict_t* copy = dict_deserialize( (dict_args_t) { .key = { .type = DICT_STR }, .val = { .size = sizeof (profile_t), .split = true } }, data );
+    free( data );
+    printf( "strings: %zu, beta %ld, gamma %ld, has alpha: %d\n", dict_len( copy ), ( (profile_t*) dict_find( copy, "beta" ) )->id, ( (profile_t*) dict_find( copy, "gamma" ) )->id, dict_has( copy, "alpha" ) );
+    dict_destroy( copy );
+    dict_destroy( words );
+
+    // merging between the two layouts copies the vals, not the arena pointers
+    dict_t* left  = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) } );
+    dict_t* right = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t), .split = true } );
+    *(int64_t*) dict_get( left, (int64_t) 4 ) = 400;
+    *(int64_t*) dict_get( left, (int64_t) 5 ) = -1;
+    *(int64_t*) dict_get( right, (int64_t) 5 ) = 500;
+    *(int64_t*) dict_get( right, (int64_t) 6 ) = 600;
+    dict_merge( left, right, DICT_OVERWRITE, NULL, NULL );
+    dict_merge( right, left, DICT_KEEP, NULL, NULL );
+    printf( "merged: 5 -> %ld, 6 -> %ld, into split: 4 -> %ld\n", *(int64_t*) dict_find( left, (int64_t) 5 ), *(int64_t*) dict_find( left, (int64_t) 6 ), *(int64_t*) dict_find( right, (int64_t) 4 ) );
+    *(int64_t*) dict_get( right, (int64_t) 7 ) = 700;
+    dict_merge_move( left, right, DICT_OVERWRITE, NULL, NULL );
+    printf( "moved: len %zu, 7 -> %ld, left in split: %zu\n", dict_len( left ), *(int64_t*) dict_find( left, (int64_t) 7 ), dict_len( right ) );
+    dict_destroy( left );
+    dict_destroy( right );
+
+    dict_destroy( plain );
+    dict_destroy( split );
+    return 0;
+}
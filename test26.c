@@ -0,0 +1,62 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+#define AMOUNT 100000
+#define SAMPLE 16
+
+int main( void )
+{
+    // percentiles of a histogram filled by hand, each one within 1/8 of the exact latency
+    dict_prof_hist_t hist = { 0 };
+    for ( size_t i = 0; i < DICT_PROF_BUCKETS && dict_profile_bound( i ) <= 1000000; i++ )
+    {
+        hist.buckets[i] = 1;
+        hist.count++;
+        hist.max = dict_profile_bound( i );
+    }
+    uint64_t p50 = dict_profile_percentile( &hist, 0.5 );
+    uint64_t lo  = dict_profile_bound( hist.count / 2 - 1 );
+    printf( "buckets up to 1ms: %lu, p50 near %lu: %d, p100: %lu\n", hist.count, lo, p50 >= lo && p50 - lo <= lo / 8, dict_profile_percentile( &hist, 1.0 ) );
+
+    dict_t* dict = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    if ( dict_profile_start( dict, SAMPLE ) == false )
+    {
+        printf( "built without DICT_PROFILE, profile: %d, dump: %d\n", dict_profile( dict ) != NULL, dict_profile_dump( dict, stderr ) );
+        dict_destroy( dict );
+        return 0;
+    }
+
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        *(int64_t*) dict_get( dict, i ) = i;
+    }
+    size_t found = 0;
+    for ( int64_t i = 0; i < AMOUNT * 2; i++ )
+    {
+        found += dict_find( dict, i ) != NULL;
+    }
+    for ( int64_t i = 0; i < AMOUNT; i += 2 )
+    {
+        dict_remove( dict, i );
+    }
+    size_t bytes;
+    free( dict_serialize( dict, &bytes ) );
+
+    const dict_profile_t* prof = dict_profile( dict );
+    const dict_prof_resize_t* last = &prof->resize[ ( prof->resizes - 1 ) % DICT_PROF_RESIZES ];
+    printf( "found %zu, sampled get: %lu, find: %lu, remove: %lu, serialize: %lu\n", found, prof->ops[ DICT_PROF_GET ].count,
+            prof->ops[ DICT_PROF_FIND ].count, prof->ops[ DICT_PROF_REMOVE ].count, prof->ops[ DICT_PROF_SERIALIZE ].count );
+    const dict_prof_hist_t* get = &prof->ops[ DICT_PROF_GET ];
+    bool ordered = dict_profile_percentile( get, 0.5 ) <= dict_profile_percentile( get, 0.99 ) && dict_profile_percentile( get, 0.99 ) <= get->max;
+    printf( "resizes: %lu, reshape: %lu, last %zu -> %zu at %zu pairs, ordered: %d\n", prof->resizes, prof->ops[ DICT_PROF_RESHAPE ].count,
+            last->from, last->to, last->len, ordered );
+    dict_profile_dump( dict, stderr );
+
+    // stopped, nothing is collected anymore
+    dict_profile_stop( dict );
+    dict_get( dict, (int64_t) -1 );
+    printf( "stopped: %d\n", dict_profile( dict ) == NULL );
+    dict_destroy( dict );
+
+    return 0;
+}
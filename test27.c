@@ -0,0 +1,104 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define OBJECTS 1000000
+
+typedef struct
+{
+    size_t calls;
+    size_t live;
+} counter_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// dict_alloc, counts the allocations and the bytes still in use
+void* count_alloc( void* ctx, size_t size, size_t align )
+{
+    (void) align;
+    counter_t* counter = ctx;
+    counter->calls++;
+    counter->live += size;
+    return malloc( size );
+}
+
+// dict_dealloc
+void count_dealloc( void* ctx, void* ptr, size_t size )
+{
+    counter_t* counter = ctx;
+    counter->live -= size;
+    free( ptr );
+}
+
+int main( void )
+{
+    counter_t counter = { 0 };
+    dict_alloc_t alloc = { .ctx = &counter, .alloc = count_alloc, .dealloc = count_dealloc };
+
+    // an empty dict is a single allocation, the first pairs share one inline bucket
+    dict_t* attrs = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (int64_t) }, .alloc = alloc );
+    size_t empty = counter.calls;
+    char name[16];
+    for ( int64_t i = 0; i < 8; i++ )
+    {
+        snprintf( name, sizeof name, "attr%ld", i );
+        *(int64_t*) dict_get( attrs, name ) = i;
+    }
+    printf( "empty: %zu allocation, 8 pairs: %zu buckets, found attr5: %ld\n", empty, dict_stats( attrs ).buckets, *(int64_t*) dict_find( attrs, "attr5" ) );
+
+    // the bucket array comes with the ninth pair
+    *(int64_t*) dict_get( attrs, "attr8" ) = 8;
+    printf( "9 pairs: %zu buckets, has attr0: %d, has attr9: %d\n", dict_stats( attrs ).buckets, dict_has( attrs, "attr0" ), dict_has( attrs, "attr9" ) );
+    for ( int64_t i = 0; i < 9; i++ )
+    {
+        snprintf( name, sizeof name, "attr%ld", i );
+        dict_remove( attrs, name );
+    }
+    dict_destroy( attrs );
+    printf( "everything given back: %d\n", counter.live == 0 );
+
+    // direct-indexed keys give the bucket array back and start over from the inline bucket when they get sparse again
+    dict_t* dense = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = sizeof (int32_t) }, .dense = { .enable = true } );
+    for ( int32_t i = 0; i < 100; i++ )
+    {
+        *(int32_t*) dict_get( dense, i * 1000 ) = i;
+    }
+    bool sparse = dict_stats( dense ).dense;
+    for ( int32_t i = 0; i < 100000; i++ )
+    {
+        *(int32_t*) dict_get( dense, i ) = i;
+    }
+    bool filled = dict_stats( dense ).dense;
+    *(int32_t*) dict_get( dense, 1 << 30 ) = -1;
+    printf( "dense: %d then %d then %d, buckets %zu, 42000 -> %d, far -> %d\n", sparse, filled, dict_stats( dense ).dense, dict_stats( dense ).buckets,
+            *(int32_t*) dict_find( dense, 42000 ), *(int32_t*) dict_find( dense, 1 << 30 ) );
+    dict_destroy( dense );
+
+    // many tiny dicts, e.g. attributes of objects
+    double   start = now();
+    dict_t** maps  = malloc( sizeof (dict_t*) * OBJECTS );
+    size_t   total = 0;
+    for ( size_t i = 0; i < OBJECTS; i++ )
+    {
+        maps[i] = dict_new( DICT_I32, 0, sizeof (int32_t) );
+        for ( int32_t k = 0; k < (int32_t) ( i % 5 ); k++ )
+        {
+            *(int32_t*) dict_get( maps[i], k ) = k;
+        }
+    }
+    for ( size_t i = 0; i < OBJECTS; i++ )
+    {
+        total += dict_len( maps[i] );
+        dict_destroy( maps[i] );
+    }
+    free( maps );
+    fprintf( stderr, "%d small dicts: %.1f ms\n", OBJECTS, ( now() - start ) * 1e3 );
+    printf( "small dicts: %zu pairs\n", total );
+
+    return 0;
+}
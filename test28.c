@@ -0,0 +1,112 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT 1000000
+
+static size_t freed = 0;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// dict_pred, entries last seen before `ctx`
+bool stale( const void* key, const void* val, void* ctx )
+{
+    (void) key;
+    return *(const int64_t*) val < *(int64_t*) ctx;
+}
+
+// dict_pred
+bool even( const void* key, const void* val, void* ctx )
+{
+    (void) val;
+    (void) ctx;
+    return *(const int32_t*) key % 2 == 0;
+}
+
+// dict_desctructor
+void drop_note( void* ptr )
+{
+    free( *(char**) ptr );
+    freed++;
+}
+
+static dict_t* fill( void )
+{
+    dict_t* dict = dict_new( DICT_I64, 0, sizeof (int64_t) );
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        *(int64_t*) dict_get( dict, i * 7 ) = i % 100;     // last seen
+    }
+    return dict;
+}
+
+int main( void )
+{
+    // the old way, a copy of the keys and two lookups per pair
+    dict_t* slow  = fill();
+    int64_t limit = 90;
+    double  start = now();
+    size_t  len;
+    const int64_t* keys = dict_key( slow, &len );
+    for ( size_t i = 0; i < len; i++ )
+    {
+        if ( *(int64_t*) dict_find( slow, keys[i] ) < limit )
+        {
+            dict_remove( slow, keys[i] );
+        }
+    }
+    free( (void*) keys );
+    double before = now() - start;
+
+    dict_t* fast = fill();
+    start = now();
+    size_t removed = dict_remove_if( fast, stale, &limit );
+    fprintf( stderr, "lookups %.1f ms, dict_remove_if %.1f ms\n", before * 1e3, ( now() - start ) * 1e3 );
+
+    bool same = dict_len( fast ) == dict_len( slow );
+    keys = dict_key( fast, &len );
+    for ( size_t i = 0; i < len; i++ )
+    {
+        same = same && dict_has( slow, keys[i] );
+    }
+    free( (void*) keys );
+    printf( "removed %zu, left %zu, same as lookups: %d, buckets %zu\n", removed, dict_len( fast ), same, dict_stats( fast ).buckets );
+    dict_destroy( slow );
+
+    // the buckets are given back as the dict gets emptier, down to the inline bucket
+    limit = 99;
+    removed = dict_remove_if( fast, stale, &limit );
+    size_t buckets = dict_stats( fast ).buckets;
+    limit = 100;
+    size_t rest = dict_remove_if( fast, stale, &limit );
+    *(int64_t*) dict_get( fast, (int64_t) 1 ) = 1;
+    printf( "removed %zu, buckets %zu, then removed %zu, buckets %zu, has 1: %d\n", removed, buckets, rest, dict_stats( fast ).buckets, dict_has( fast, (int64_t) 1 ) );
+    dict_destroy( fast );
+
+    // vals owning memory, ordered keys
+    dict_t* notes = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = sizeof (char*), .free = drop_note }, .order = { .enable = true } );
+    for ( int32_t i = 0; i < 1000; i++ )
+    {
+        *(char**) dict_get( notes, i ) = strdup( "note" );
+    }
+    removed = dict_retain( notes, even, NULL );
+    printf( "retained %zu, removed %zu, freed %zu, in 0..9: %zu\n", dict_len( notes ), removed, freed, dict_range( notes, NULL, NULL, 0, 9 ) );
+    dict_destroy( notes );
+
+    // direct-indexed
+    dict_t* dense = dict_create_args( .key = { .type = DICT_I32 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } );
+    for ( int32_t i = 0; i < 1000; i++ )
+    {
+        *(int64_t*) dict_get( dense, i ) = i;
+    }
+    removed = dict_remove_if( dense, even, NULL );
+    printf( "dense: %d, removed %zu, has 2: %d, has 3: %d\n", dict_stats( dense ).dense, removed, dict_has( dense, 2 ), dict_has( dense, 3 ) );
+    dict_destroy( dense );
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define AMOUNT  1000000
+#define THREADS 4
+
+typedef struct
+{
+    int64_t id;
+    double  score;
+} row_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main( void )
+{
+    dict_t* dict = dict_new( DICT_I64, 0, sizeof (double) );
+    for ( int64_t i = 0; i < AMOUNT; i++ )
+    {
+        *(double*) dict_get( dict, i * 3 ) = i * 0.5;
+    }
+
+    // the old way, a copy of the keys and a lookup per val
+    double start = now();
+    size_t len;
+    const int64_t* copy = dict_key( dict, &len );
+    double* looked = malloc( sizeof (double) * len );
+    for ( size_t i = 0; i < len; i++ )
+    {
+        looked[i] = *(double*) dict_find( dict, copy[i] );
+    }
+    double before = now() - start;
+
+    // packed columns, one thread and several
+    int64_t* keys = malloc( sizeof (int64_t) * AMOUNT );
+    double*  vals = malloc( sizeof (double) * AMOUNT );
+    start = now();
+    size_t rows = dict_export( dict, keys, 0, vals, 0, AMOUNT, 1 );
+    double serial = now() - start;
+    int64_t* keys2 = malloc( sizeof (int64_t) * AMOUNT );
+    double*  vals2 = malloc( sizeof (double) * AMOUNT );
+    start = now();
+    size_t rows2 = dict_export( dict, keys2, 0, vals2, 0, AMOUNT, THREADS );
+    fprintf( stderr, "dict_key and lookups %.1f ms, export %.1f ms, %d threads %.1f ms\n", before * 1e3, serial * 1e3, THREADS, ( now() - start ) * 1e3 );
+
+    bool same = rows == len && rows2 == len && memcmp( keys, copy, sizeof (int64_t) * len ) == 0 && memcmp( vals, looked, sizeof (double) * len ) == 0
+             && memcmp( keys, keys2, sizeof (int64_t) * len ) == 0 && memcmp( vals, vals2, sizeof (double) * len ) == 0;
+    printf( "rows %zu, same as dict_key and lookups: %d\n", rows, same );
+    free( (void*) copy );
+    free( looked );
+    free( keys2 );
+    free( vals2 );
+
+    // rows of a struct through the strides, and fewer rows than pairs
+    row_t* table = malloc( sizeof (row_t) * 10 );
+    rows = dict_export( dict, &table[0].id, sizeof (row_t), &table[0].score, sizeof (row_t), 10, THREADS );
+    same = true;
+    for ( size_t i = 0; i < rows; i++ )
+    {
+        same = same && table[i].id == keys[i] && table[i].score == vals[i];
+    }
+    printf( "strided rows %zu, same: %d\n", rows, same );
+    free( table );
+
+    // bulk load from the columns
+    dict_t* back = dict_new( DICT_I64, 0, sizeof (double) );
+    size_t inserted = dict_import( back, keys, 0, vals, 0, AMOUNT );
+    printf( "imported %zu, len %zu, 300 -> %.1f, again: %zu\n", inserted, dict_len( back ), *(double*) dict_find( back, (int64_t) 300 ), dict_import( back, keys, 0, vals, 0, 10 ) );
+    dict_destroy( back );
+    dict_destroy( dict );
+    free( keys );
+    free( vals );
+
+    // string keys as offsets and one blob
+    dict_t* words = dict_new( DICT_STR, 0, sizeof (int32_t) );
+    const char* list[] = { "apple", "kiwi", "", "dragonfruit", "fig" };
+    for ( int32_t i = 0; i < 5; i++ )
+    {
+        *(int32_t*) dict_get( words, list[i] ) = i;
+    }
+    size_t bytes;
+    dict_export_str( words, NULL, NULL, &bytes, NULL, 0, 0 );
+    uint64_t offsets[6];
+    int32_t  ids[5];
+    char*    blob = malloc( bytes );
+    size_t   blob_size = bytes;
+    rows = dict_export_str( words, offsets, blob, &bytes, ids, 0, 5 );
+    printf( "strings %zu, %zu bytes:", rows, bytes );
+    for ( size_t i = 0; i < rows; i++ )
+    {
+        printf( " %.*s=%d", (int) ( offsets[ i + 1 ] - offsets[i] ), blob + offsets[i], ids[i] );
+    }
+    printf( "\n" );
+
+    // a blob too small for every key
+    bytes = 8;
+    printf( "fits in 8 bytes: %zu rows\n", dict_export_str( words, offsets, blob, &bytes, NULL, 0, 5 ) );
+    bytes = blob_size;
+    dict_export_str( words, offsets, blob, &bytes, ids, 0, 5 );
+
+    dict_t* again = dict_new( DICT_STR, 0, sizeof (int32_t) );
+    inserted = dict_import_str( again, offsets, blob, ids, 0, rows );
+    printf( "imported %zu, dragonfruit -> %d, empty -> %d\n", inserted, *(int32_t*) dict_find( again, "dragonfruit" ), *(int32_t*) dict_find( again, "" ) );
+    free( blob );
+    dict_destroy( again );
+    dict_destroy( words );
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <time.h>
+
+#define DICTS   100
+#define KEYS    1000
+#define LOOKUPS 10000000
+
+typedef struct
+{
+    size_t live;
+} counter_t;
+
+static double now( void )
+{
+    struct timespec ts;
+    timespec_get( &ts, TIME_UTC );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// dict_alloc, counts the bytes still in use
+void* count_alloc( void* ctx, size_t size, size_t align )
+{
+    (void) align;
+    ( (counter_t*) ctx )->live += size;
+    return malloc( size );
+}
+
+// dict_dealloc
+void count_dealloc( void* ctx, void* ptr, size_t size )
+{
+    ( (counter_t*) ctx )->live -= size;
+    free( ptr );
+}
+
+// many dicts with the same keys, e.g. the field names of records
+static void fill( dict_t** dicts, dict_pool_t* pool, dict_alloc_t alloc )
+{
+    char name[32];
+    for ( size_t i = 0; i < DICTS; i++ )
+    {
+        dicts[i] = dict_create_args( .key = { .type = DICT_STR, .pool = pool }, .val = { .size = sizeof (int64_t) }, .alloc = alloc );
+        for ( int64_t k = 0; k < KEYS; k++ )
+        {
+            snprintf( name, sizeof name, "field_name_%ld", k );
+            *(int64_t*) dict_get( dicts[i], name ) = k;
+        }
+    }
+}
+
+int main( void )
+{
+    dict_t* dicts[ DICTS ];
+
+    // every dict holds its own copy of the keys
+    counter_t    apart = { 0 };
+    dict_alloc_t alloc = { .ctx = &apart, .alloc = count_alloc, .dealloc = count_dealloc };
+    fill( dicts, NULL, alloc );
+    size_t copied = apart.live;
+    for ( size_t i = 0; i < DICTS; i++ )
+    {
+        dict_destroy( dicts[i] );
+    }
+
+    // one copy in the pool
+    counter_t    shared = { 0 };
+    dict_alloc_t pooled = { .ctx = &shared, .alloc = count_alloc, .dealloc = count_dealloc };
+    dict_pool_t* pool   = dict_pool_create( pooled );
+    fill( dicts, pool, pooled );
+    printf( "%d dicts of %d keys, pool holds %zu strings, uses less memory: %d\n", DICTS, KEYS, dict_pool_len( pool ), shared.live < copied );
+    fprintf( stderr, "copied keys %zu bytes, pooled keys %zu bytes\n", copied, shared.live );
+
+    // interned lookups are matched by address with the cached code
+    const char* key = dict_pool_intern( pool, "field_name_500" );
+    printf( "interned: %s, length %zu, hash same as the dict: %d\n", key, dict_pool_length( key ), dict_pool_hash( key ) == dict_hash_key( dicts[7], "field_name_500" ) );
+    int64_t sum   = 0;
+    double  start = now();
+    for ( size_t i = 0; i < LOOKUPS; i++ )
+    {
+        sum += *(int64_t*) dict_find( dicts[ i % DICTS ], "field_name_500" );
+    }
+    double plain = now() - start;
+    start = now();
+    for ( size_t i = 0; i < LOOKUPS; i++ )
+    {
+        sum += *(int64_t*) dict_find_prehashed( dicts[ i % DICTS ], dict_pool_hash( key ), key );
+    }
+    fprintf( stderr, "dict_find %.1f ms, interned dict_find_prehashed %.1f ms\n", plain * 1e3, ( now() - start ) * 1e3 );
+    printf( "sum %ld, missing: %d\n", sum, dict_find( dicts[0], "field_name_5000" ) == NULL );
+
+    // keys are released as they leave the dicts
+    dict_remove( dicts[0], "field_name_999" );
+    size_t kept = dict_pool_len( pool );
+    for ( size_t i = 1; i < DICTS; i++ )
+    {
+        dict_remove( dicts[i], "field_name_999" );
+    }
+    printf( "removed from one dict: %zu strings, from all: %zu\n", kept, dict_pool_len( pool ) );
+
+    // deserialized keys go to the pool too
+    size_t bytes;
+    void*   data = dict_serialize( dicts[3], &bytes );
+    dict_t* back = dict_deserialize( (dict_args_t) { .key = { .type = DICT_STR, .pool = pool }, .val = { .size = sizeof (int64_t) }, .alloc = pooled }, data );
+    count_dealloc( &shared, data, bytes );
+    printf( "deserialized %zu pairs, pool holds %zu strings, field_name_42 -> %ld\n", dict_len( back ), dict_pool_len( pool ), *(int64_t*) dict_find( back, "field_name_42" ) );
+    dict_destroy( back );
+
+    for ( size_t i = 0; i < DICTS; i++ )
+    {
+        dict_destroy( dicts[i] );
+    }
+    printf( "after every dict: %zu strings, the interned one: %s\n", dict_pool_len( pool ), key );
+    dict_pool_release( pool, key );
+    printf( "released: %zu strings\n", dict_pool_len( pool ) );
+    dict_pool_destroy( pool );
+    printf( "everything given back: %d\n", shared.live == 0 );
+
+    return 0;
+}
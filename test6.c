@@ -0,0 +1,44 @@
+#include "src/dict.h"
+#include <stdint.h>
+#include <inttypes.h>
+
+#define dict_int64( dict, key ) ( *(int64_t*) dict_get( dict, key ) )
+
+int main( void )
+{
+    // integer keys close to each other are stored in a direct-indexed array
+    dict_t* dict = dict_create_args( .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } );
+
+    for ( int64_t i = -100; i < 1000; i++ )
+    {
+        dict_int64( dict, i ) = i * 2;
+    }
+    printf( "len: %zu, has 999: %d, has 1000: %d\n", dict_len( dict ), dict_has( dict, (int64_t) 999 ), dict_has( dict, (int64_t) 1000 ) );
+
+    // a far away key makes the range sparse, the dict falls back to hashing
+    dict_int64( dict, (int64_t) 1 << 40 ) = 42;
+    printf( "len: %zu, far: %" PRId64 ", -100: %" PRId64 "\n", dict_len( dict ), dict_int64( dict, (int64_t) 1 << 40 ), dict_int64( dict, (int64_t) -100 ) );
+
+    for ( int64_t i = -100; i < 1000; i += 2 )
+    {
+        dict_remove( dict, i );
+    }
+    printf( "len: %zu, has -100: %d, has -99: %d, remove twice: %d\n", dict_len( dict ), dict_has( dict, (int64_t) -100 ), dict_has( dict, (int64_t) -99 ), dict_remove( dict, (int64_t) -100 ) );
+
+    size_t size;
+    void* data = dict_serialize( dict, &size );
+    dict_destroy( dict );
+
+    dict = dict_deserialize( (dict_args_t) { .key = { .type = DICT_I64 }, .val = { .size = sizeof (int64_t) }, .dense = { .enable = true } }, data );
+    free( data );
+    int64_t sum = 0;
+    for ( int64_t i = -99; i < 1000; i += 2 )
+    {
+        sum += dict_int64( dict, i );
+    }
+    printf( "len: %zu, sum: %" PRId64 "\n", dict_len( dict ), sum );
+
+    dict_destroy( dict );
+
+    return 0;
+}
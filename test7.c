@@ -0,0 +1,40 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+int main( void )
+{
+    // a set of blocked strings, most lookups miss
+    dict_t* dict = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = 0 }, .filter = { .enable = true } );
+
+    char buf[32];
+    for ( int i = 0; i < 10000; i++ )
+    {
+        snprintf( buf, sizeof buf, "blocked-%d", i );
+        dict_get( dict, buf );
+    }
+
+    size_t hit = 0;
+    for ( int i = 0; i < 100000; i++ )
+    {
+        snprintf( buf, sizeof buf, "visitor-%d", i );
+        hit += dict_find( dict, buf ) != NULL;
+    }
+    for ( int i = 0; i < 10000; i += 2 )
+    {
+        snprintf( buf, sizeof buf, "blocked-%d", i );
+        dict_remove( dict, buf );
+    }
+    for ( int i = 0; i < 10000; i++ )
+    {
+        snprintf( buf, sizeof buf, "blocked-%d", i );
+        hit += dict_find( dict, buf ) != NULL;
+    }
+
+    dict_stats_t stats = dict_stats( dict );
+    printf( "len: %zu, hit: %zu, fpr below 5%%: %s\n", stats.len, hit, stats.filter_fpr < 0.05 ? "yes" : "no" );
+    printf( "queries: %lu, answered by filter: %s\n", stats.filter_queries, stats.filter_negatives > stats.filter_queries / 2 ? "most" : "few" );
+
+    dict_destroy( dict );
+
+    return 0;
+}
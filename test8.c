@@ -0,0 +1,40 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+static size_t evicted = 0;
+
+// dict_evict
+void on_evict( const void* key, void* val, void* ctx )
+{
+    (void) key;
+    (void) ctx;
+    evicted += *(uint64_t*) val;
+}
+
+int main( void )
+{
+    // keep at most 100 pairs, the least recently used ones are evicted first
+    dict_t* dict = dict_create_args( .key = { .type = DICT_U64 }, .val = { .size = sizeof (uint64_t) }, .cache = { .max_len = 100, .evict = on_evict } );
+
+    for ( uint64_t i = 0; i < 100000; i++ )
+    {
+        *(uint64_t*) dict_get( dict, i ) = 1;
+        // key 0 stays hot
+        dict_has( dict, (uint64_t) 0 );
+    }
+    printf( "len: %zu, evicted: %zu, has 0: %d, has 99999: %d, has 1: %d\n", dict_len( dict ), evicted, dict_has( dict, (uint64_t) 0 ), dict_has( dict, (uint64_t) 99999 ), dict_has( dict, (uint64_t) 1 ) );
+    dict_destroy( dict );
+
+    // memory budget for string keys
+    dict = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (uint64_t) }, .cache = { .max_bytes = 1 << 16 } );
+    char buf[32];
+    for ( int i = 0; i < 100000; i++ )
+    {
+        snprintf( buf, sizeof buf, "session-%d", i );
+        *(uint64_t*) dict_get( dict, buf ) = i;
+    }
+    printf( "bounded: %s, has last: %d\n", dict_len( dict ) < 2000 ? "yes" : "no", dict_has( dict, buf ) );
+    dict_destroy( dict );
+
+    return 0;
+}
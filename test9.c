@@ -0,0 +1,59 @@
+#include "src/dict.h"
+#include <stdint.h>
+
+typedef struct
+{
+    char*   name;
+    size_t  hits;
+} entry_t;
+
+// dict_val_init
+void entry_init( const void* key, void* val, void* ctx )
+{
+    entry_t* entry = val;
+    entry->name = strdup( *(char**) key );
+    (*(size_t*) ctx)++;
+}
+
+// dict_desctructor
+void entry_free( void* ptr )
+{
+    free( ( (entry_t*) ptr )->name );
+}
+
+int main( void )
+{
+    dict_t* dict = dict_create_args( .key = { .type = DICT_STR }, .val = { .size = sizeof (entry_t), .free = entry_free } );
+
+    // plain lookup never inserts
+    printf( "find missing: %s, len: %zu\n", dict_find( dict, "apple" ) == NULL ? "NULL" : "found", dict_len( dict ) );
+
+    // init only runs once per key
+    size_t created = 0;
+    const char* words[] = { "apple", "pear", "apple", "plum", "pear", "apple" };
+    for ( size_t i = 0; i < sizeof words / sizeof words[0]; i++ )
+    {
+        entry_t* entry = dict_get_or_init( dict, entry_init, &created, words[i] );
+        entry->hits++;
+    }
+    printf( "created: %zu, apple hits: %zu\n", created, ( (entry_t*) dict_find( dict, "apple" ) )->hits );
+
+    bool inserted;
+    dict_upsert( dict, &inserted, "pear" );
+    printf( "upsert pear inserted: %d, ", inserted );
+    entry_t* fig = dict_upsert( dict, &inserted, "fig" );
+    fig->name = strdup( "fig" );
+    printf( "upsert fig inserted: %d\n", inserted );
+
+    // take moves the val out, the caller now owns `name`
+    entry_t taken;
+    if ( dict_take( dict, &taken, "apple" ) )
+    {
+        printf( "took %s with %zu hits, has apple: %d, take again: %d\n", taken.name, taken.hits, dict_has( dict, "apple" ), dict_take( dict, &taken, "apple" ) );
+        free( taken.name );
+    }
+
+    dict_destroy( dict );
+
+    return 0;
+}